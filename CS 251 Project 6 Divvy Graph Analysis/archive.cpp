@@ -0,0 +1,896 @@
+//
+// archive.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#include <fstream>
+#include <cstring>
+#include <climits>
+#include <filesystem>
+#include <algorithm>
+#include <thread>
+#include <string_view>
+
+#include "archive.h"
+#include "hashindex.h"
+#include "stats.h"
+#include "stringpool.h"
+#include "timebuckets.h"
+#include "tripfiles.h"
+
+using namespace std;
+
+
+// the columns of a block, in the order they are stored
+enum ArchiveColumn
+{
+	FlagsColumn,
+	TripIDColumn,
+	TimeColumn,
+	BucketColumn,
+	FromColumn,
+	ToColumn,
+	BikeIDColumn,
+	DurationColumn,
+	BirthYearColumn,
+	UserTypeColumn,
+	GenderColumn
+};
+
+const int BirthYearBase = 1970;		// birth years are stored relative to it
+
+
+//
+// zigzag coding: small values of either sign become small unsigned
+// ones, 0, -1, 1, -2, .. -> 0, 1, 2, 3, ..
+//
+static uint32_t ZigZag(int32_t v)
+{
+	return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t UnZigZag(uint32_t u)
+{
+	return (int32_t)((u >> 1) ^ (0u - (u & 1)));
+}
+
+
+//
+// appends u as a varint: 7 bits per byte, low bits first, the high bit
+// set on every byte but the last
+//
+static void PutVarint(string& out, uint32_t u)
+{
+	while (u >= 0x80) {
+		out.push_back((char)(u | 0x80));
+		u >>= 7;
+	}
+	out.push_back((char)u);
+}
+
+
+//
+// rounds n up to a multiple of 8
+//
+static size_t Align8(size_t n)
+{
+	return (n + 7) & ~(size_t)7;
+}
+
+
+//
+// ColumnReader class
+//
+// Reads the varints of one column, never past its end; once a read
+// runs off the end, every later read returns 0 and Done() is false.
+//
+class ColumnReader
+{
+private:
+	const uint8_t *Cur;				// next byte
+	const uint8_t *End;				// one past the last byte
+	bool           Ok;				// false once a read ran off the end
+
+public:
+	ColumnReader(const uint8_t *begin, const uint8_t *end)
+	{
+		this->Cur = begin;
+		this->End = end;
+		this->Ok = true;
+	}
+
+	uint32_t Next()
+	{
+		// one byte is by far the most common
+		if (this->Cur < this->End && *this->Cur < 0x80)
+			return *this->Cur++;
+
+		uint32_t u = 0;
+		for (int shift = 0; shift < 35; shift += 7) {
+			if (this->Cur >= this->End) {
+				this->Ok = false;
+				return 0;
+			}
+
+			uint8_t b = *this->Cur++;
+			u |= (uint32_t)(b & 0x7f) << shift;
+			if (b < 0x80)
+				return u;
+		}
+
+		this->Ok = false;			// more than 5 bytes
+		return 0;
+	}
+
+	// true if every read succeeded and the column is used up
+	bool Done()
+	{
+		return this->Ok && this->Cur == this->End;
+	}
+};
+
+
+//
+// Record class
+//
+// One trip on its way into the archive.  The strings point into the
+// mapped trips file (or archive) it came from.
+//
+class Record
+{
+public:
+	uint8_t     Flags;				// TripArchive::Has.. bits
+	int32_t     TripID;
+	int32_t     StartTime;			// seconds since 1/1/2000
+	int32_t     Bucket;				// time bucket
+	int32_t     FromID, ToID;		// Divvy station ids
+	int32_t     BikeID;
+	int32_t     Duration;			// seconds
+	int16_t     BirthYear;			// 0 if not given
+	string_view UserType, Gender;
+};
+
+
+//
+// parses the trips in [begin, end), which must start at the beginning
+// of a line, into records.  A line is kept if ProcessTrips would read
+// it (the station ids parse); which other fields parse, the way the
+// trip store reads them, is in its flags.
+//
+static void ParseLines(const char *begin, const char *end, vector<Record>& records)
+{
+	CsvScanner  input(begin, end - begin);
+	string_view line;
+
+	while (input.NextLine(line))
+	{
+		// format:
+		//   trip_id,starttime,stoptime,bikeid,tripduration,from_station_id,from_station_name,to_station_id,to_station_name,usertype,gender,birthyear
+		//   10426287,6/30/2016 22:48,6/30/2016 23:13,4199,1521,145,Mies van der Rohe Way & Chestnut St,35,Streeter Dr & Grand Ave,Customer,,
+		//
+		string_view fields[12];
+		Record      r = Record();
+		int         year, birthYear = 0;
+		double      seconds;
+
+		int numFields = CsvScanner::Split(line, fields, 12);
+		if (numFields < 8
+			|| !CsvScanner::ParseInt(fields[5], r.FromID)
+			|| !CsvScanner::ParseInt(fields[7], r.ToID))
+			continue;
+
+		if (CsvScanner::ParseInt(fields[0], r.TripID))
+			r.Flags |= TripArchive::HasTripID;
+
+		// the time in seconds if the trip store takes it, else at least
+		// the bucket for the graph
+		r.Bucket = ParseTimeBucket(fields[1], year, r.StartTime);
+		if (r.Bucket != -1)
+			r.Flags |= TripArchive::HasTime;
+		else if ((r.Bucket = ParseTimeBucket(fields[1])) != -1)
+			r.Flags |= TripArchive::HasBucket;
+
+		// the fields only the trip store reads
+		if (numFields >= 10 && CsvScanner::ParseInt(fields[3], r.BikeID)) {
+			r.Flags |= TripArchive::HasDetail;
+			r.UserType = fields[9];
+			r.Gender = (numFields >= 11) ? fields[10] : string_view();
+
+			if (numFields >= 12 && !fields[11].empty() && !CsvScanner::ParseInt(fields[11], birthYear))
+				birthYear = 0;
+			r.BirthYear = (int16_t)birthYear;
+
+			if (CsvScanner::ParseInt(fields[4], r.Duration)) {
+				r.Flags |= TripArchive::HasDuration;
+			}
+			else if (CsvScanner::ParseDouble(fields[4], seconds)) {
+				r.Duration = (int)(seconds + 0.5);
+				r.Flags |= TripArchive::HasDuration;
+			}
+		}
+
+		records.push_back(r);
+	}
+}
+
+
+//
+// appends the trips of block b of the archive to records, returns
+// false if the block cannot be decoded
+//
+static bool ReadBlock(TripArchive& archive, int b, vector<Record>& records)
+{
+	TripArchive::Rows rows;
+	if (!archive.Decode(b, rows, true))
+		return false;
+
+	for (size_t i = 0; i < rows.Flags.size(); i++) {
+		Record r = Record();
+
+		r.Flags = rows.Flags[i];
+		r.TripID = rows.TripIDs[i];
+		r.StartTime = rows.StartTimes[i];
+		r.Bucket = rows.Buckets[i];
+		r.FromID = archive.GetStationID(rows.From[i]);
+		r.ToID = archive.GetStationID(rows.To[i]);
+		r.BikeID = rows.BikeIDs[i];
+		r.Duration = rows.Durations[i];
+		r.BirthYear = rows.BirthYears[i];
+
+		if (r.Flags & TripArchive::HasDetail) {
+			r.UserType = archive.GetUserTypes()[rows.UserTypes[i]];
+			r.Gender = archive.GetGenders()[rows.Genders[i]];
+		}
+
+		records.push_back(r);
+	}
+
+	return true;
+}
+
+
+//
+// ArchiveWriter class
+//
+// Codes the trips into blocks, building the dictionaries as it goes.
+//
+class ArchiveWriter
+{
+private:
+	HashIndex<int>       StationCodes;		// Divvy station id -> code
+	vector<int32_t>      StationIDs;		// code -> Divvy station id
+	StringPool           UserTypes;			// usertype text -> code
+	StringPool           Genders;			// gender text -> code
+	vector<Record>       Pending;			// trips of the block being filled
+	vector<ArchiveBlock> Blocks;			// directory so far, offsets into Bytes
+	string               Bytes;				// blocks so far
+	uint64_t             NumTrips;			// # of trips so far
+
+	//
+	// code of the given station id, adding it if new
+	//
+	int StationCode(int id)
+	{
+		int code = this->StationCodes.Find(id);
+		if (code == -1) {
+			code = (int)this->StationIDs.size();
+			this->StationIDs.push_back(id);
+			this->StationCodes.Insert(id, code);
+		}
+		return code;
+	}
+
+	//
+	// codes the pending trips as the next block
+	//
+	void Flush()
+	{
+		if (this->Pending.empty())
+			return;
+
+		string       columns[ArchiveColumns];
+		ArchiveBlock entry;
+		uint32_t     prevID = 0, prevTime = 0;
+
+		entry.NumTrips = (uint32_t)this->Pending.size();
+		entry.MinTime = entry.MinTripID = INT_MAX;
+		entry.MaxTime = entry.MaxTripID = INT_MIN;
+
+		// flags as (value, run length) pairs
+		for (size_t i = 0; i < this->Pending.size(); ) {
+			size_t run = 1;
+			while (i + run < this->Pending.size() && this->Pending[i + run].Flags == this->Pending[i].Flags)
+				run++;
+
+			columns[FlagsColumn].push_back((char)this->Pending[i].Flags);
+			PutVarint(columns[FlagsColumn], (uint32_t)run);
+			i += run;
+		}
+
+		for (Record& r : this->Pending) {
+			// ids and times as deltas, wrapping around if need be
+			if (r.Flags & TripArchive::HasTripID) {
+				PutVarint(columns[TripIDColumn], ZigZag((int32_t)((uint32_t)r.TripID - prevID)));
+				prevID = (uint32_t)r.TripID;
+				entry.MinTripID = min(entry.MinTripID, r.TripID);
+				entry.MaxTripID = max(entry.MaxTripID, r.TripID);
+			}
+
+			if (r.Flags & TripArchive::HasTime) {
+				PutVarint(columns[TimeColumn], ZigZag((int32_t)((uint32_t)r.StartTime - prevTime)));
+				prevTime = (uint32_t)r.StartTime;
+				entry.MinTime = min(entry.MinTime, r.StartTime);
+				entry.MaxTime = max(entry.MaxTime, r.StartTime);
+			}
+			else if (r.Flags & TripArchive::HasBucket) {
+				columns[BucketColumn].push_back((char)r.Bucket);
+			}
+
+			PutVarint(columns[FromColumn], (uint32_t)this->StationCode(r.FromID));
+			PutVarint(columns[ToColumn], (uint32_t)this->StationCode(r.ToID));
+
+			if (r.Flags & TripArchive::HasDetail) {
+				PutVarint(columns[BikeIDColumn], ZigZag(r.BikeID));
+				PutVarint(columns[BirthYearColumn],
+					(r.BirthYear == 0) ? 0 : ZigZag(r.BirthYear - BirthYearBase) + 1);
+				PutVarint(columns[UserTypeColumn], (uint32_t)this->UserTypes.Intern(r.UserType));
+				PutVarint(columns[GenderColumn], (uint32_t)this->Genders.Intern(r.Gender));
+
+				if (r.Flags & TripArchive::HasDuration)
+					PutVarint(columns[DurationColumn], ZigZag(r.Duration));
+			}
+		}
+
+		// the column sizes, then the columns
+		entry.Offset = this->Bytes.size();
+		for (int c = 0; c < ArchiveColumns; c++) {
+			uint32_t size = (uint32_t)columns[c].size();
+			this->Bytes.append((const char *)&size, sizeof(size));
+		}
+		for (int c = 0; c < ArchiveColumns; c++)
+			this->Bytes += columns[c];
+		entry.Size = (uint32_t)(this->Bytes.size() - entry.Offset);
+
+		this->Blocks.push_back(entry);
+		this->NumTrips += this->Pending.size();
+		this->Pending.clear();
+	}
+
+public:
+	ArchiveWriter()
+	{
+		this->NumTrips = 0;
+	}
+
+	//
+	// adds a trip, coding a block whenever one is full
+	//
+	void Add(const Record& r)
+	{
+		this->Pending.push_back(r);
+		if ((int)this->Pending.size() == ArchiveBlockTrips)
+			this->Flush();
+	}
+
+	//
+	// codes the last block and writes the archive, returns true if
+	// successful
+	//
+	bool Write(string filename)
+	{
+		this->Flush();
+
+		// dictionary text: the usertypes, then the genders
+		vector<uint32_t> textOffsets;
+		string           text;
+		for (StringPool *pool : { &this->UserTypes, &this->Genders }) {
+			for (int code = 0; code < pool->Size(); code++) {
+				textOffsets.push_back((uint32_t)text.size());
+				text += pool->Get(code);
+			}
+		}
+		textOffsets.push_back((uint32_t)text.size());
+
+		ArchiveHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.Magic, "DIVVYARC", 8);
+		header.Version = ArchiveVersion;
+		header.NumBlocks = (uint32_t)this->Blocks.size();
+		header.NumStations = (uint32_t)this->StationIDs.size();
+		header.NumUserTypes = (uint32_t)this->UserTypes.Size();
+		header.NumGenders = (uint32_t)this->Genders.Size();
+		header.TextBytes = (uint32_t)text.size();
+		header.NumTrips = this->NumTrips;
+
+		// everything before the blocks, padded to 8 bytes
+		string prefix;
+		prefix.append((const char *)&header, sizeof(header));
+		size_t directoryAt = prefix.size();
+		prefix.append((const char *)this->Blocks.data(), this->Blocks.size() * sizeof(ArchiveBlock));
+		prefix.append((const char *)this->StationIDs.data(), this->StationIDs.size() * sizeof(int32_t));
+		prefix.append((const char *)textOffsets.data(), textOffsets.size() * sizeof(uint32_t));
+		prefix += text;
+		prefix.resize(Align8(prefix.size()), '\0');
+
+		// the blocks follow, so move the directory's offsets past the prefix
+		for (size_t b = 0; b < this->Blocks.size(); b++) {
+			ArchiveBlock entry = this->Blocks[b];
+			entry.Offset += prefix.size();
+			memcpy(&prefix[directoryAt + b * sizeof(ArchiveBlock)], &entry, sizeof(entry));
+		}
+
+		// write to a temporary file first, so a reader never sees half an archive
+		string tmpFilename = filename + ".tmp";
+		{
+			ofstream output(tmpFilename, ios::binary | ios::trunc);
+			if (!output.good())
+				return false;
+
+			output.write(prefix.data(), prefix.size());
+			output.write(this->Bytes.data(), this->Bytes.size());
+			if (!output.good())
+				return false;
+		}
+
+		error_code ec;
+		filesystem::rename(tmpFilename, filename, ec);
+		if (ec) {
+			filesystem::remove(tmpFilename, ec);
+			return false;
+		}
+
+		return true;
+	}
+
+	// # of trips added
+	long long GetNumTrips()
+	{
+		return (long long)(this->NumTrips + this->Pending.size());
+	}
+};
+
+
+//
+// WriteArchive:
+//
+// Reads the trips files (CSV files or archives, in order) and writes
+// their trips to an archive with the given filename.  A trip whose
+// trip_id was already seen is dropped, as in ProcessTrips, unless the
+// copy kept so far lacks a field the trip store needs (details,
+// duration or time) and this one has them all: the trip store keeps
+// the first copy it can read, so that one is kept too.  The files
+// are parsed in waves of numThreads chunks, coded in file order after
+// each wave, so memory stays bounded however many files there are.
+// Hands back the # of trips written and the # dropped; returns false
+// if a file cannot be read or the archive cannot be written.
+//
+bool WriteArchive(const vector<string>& tripsFilenames, string filename, int numThreads,
+	long long& numTrips, int& duplicates)
+{
+	const size_t ChunkBytes = 16 << 20;		// CSV bytes per chunk, about
+
+	numTrips = 0;
+	duplicates = 0;
+
+	TripFiles files;
+	if (tripsFilenames.empty() || !files.Open(tripsFilenames))
+		return false;
+
+	numThreads = max(numThreads, 1);
+	int chunksPerFile = max(numThreads, (int)(files.TotalSize() / tripsFilenames.size() / ChunkBytes));
+
+	vector<TripFiles::Chunk> chunks = files.Split(chunksPerFile);
+	int                      numChunks = (int)chunks.size();
+	TripIDSet                seen;
+	TripIDSet                complete;			// trips with a copy the trip store reads
+	ArchiveWriter            writer;
+
+	const uint8_t full = TripArchive::HasDetail | TripArchive::HasDuration | TripArchive::HasTime;
+
+	for (int first = 0; first < numChunks; first += numThreads) {
+		int            waveSize = min(numThreads, numChunks - first);
+		vector<vector<Record>> parts(waveSize);
+		vector<char>   failed(waveSize, 0);
+		vector<thread> workers;
+
+		for (int t = 0; t < waveSize; t++) {
+			workers.push_back(thread([&, t]() {
+				TripFiles::Chunk& chunk = chunks[first + t];
+
+				if (chunk.Archive != nullptr)
+					failed[t] = !ReadBlock(*chunk.Archive, chunk.Block, parts[t]);
+				else
+					ParseLines(chunk.Begin, chunk.End, parts[t]);
+			}));
+		}
+		for (thread& w : workers)
+			w.join();
+
+		// in file order, so the first copy of a trip is the one kept
+		for (int t = 0; t < waveSize; t++) {
+			if (failed[t])
+				return false;
+
+			for (Record& r : parts[t]) {
+				bool readable = (r.Flags & full) == full;
+
+				if ((r.Flags & TripArchive::HasTripID) && !seen.Claim(r.TripID)
+					&& !(readable && complete.Claim(r.TripID))) {
+					duplicates++;
+					continue;
+				}
+				if ((r.Flags & TripArchive::HasTripID) && readable)
+					complete.Claim(r.TripID);
+
+				writer.Add(r);
+			}
+		}
+	}
+
+	numTrips = writer.GetNumTrips();
+	return writer.Write(filename);
+}
+
+
+//
+// resizes every column to n trips of zeros; the details (bike ids on)
+// only if asked for, otherwise they are left empty
+//
+void TripArchive::Rows::Resize(size_t n, bool details)
+{
+	size_t d = details ? n : 0;
+
+	this->Flags.assign(n, 0);
+	this->TripIDs.assign(n, 0);
+	this->StartTimes.assign(n, 0);
+	this->StartYears.assign(d, 0);
+	this->Buckets.assign(n, -1);
+	this->From.assign(n, 0);
+	this->To.assign(n, 0);
+	this->BikeIDs.assign(d, 0);
+	this->Durations.assign(d, 0);
+	this->BirthYears.assign(d, 0);
+	this->UserTypes.assign(d, 0);
+	this->Genders.assign(d, 0);
+}
+
+
+//
+// Constructor:
+//
+TripArchive::TripArchive()
+{
+	this->Blocks = nullptr;
+	this->NumBlocks = 0;
+	this->NumTrips = 0;
+}
+
+
+//
+// true if the given file starts like an archive
+//
+bool TripArchive::IsArchive(const string& filename)
+{
+	char     magic[8];
+	ifstream input(filename, ios::binary);
+
+	return input.read(magic, sizeof(magic)) && memcmp(magic, "DIVVYARC", 8) == 0;
+}
+
+
+//
+// maps the archive and checks its header, directory and dictionaries;
+// returns false if the file cannot be opened or is not a sound archive
+// of this version
+//
+bool TripArchive::Open(const string& filename)
+{
+	if (!this->File.Open(filename))
+		return false;
+
+	const char *data = this->File.Data();
+	uint64_t    size = this->File.Size();
+
+	ArchiveHeader header;
+	if (size < sizeof(header))
+		return false;
+	memcpy(&header, data, sizeof(header));
+
+	if (memcmp(header.Magic, "DIVVYARC", 8) != 0 || header.Version != ArchiveVersion)
+		return false;
+
+	// the sections before the blocks must fit
+	uint64_t numTexts = (uint64_t)header.NumUserTypes + header.NumGenders;
+	uint64_t directoryAt = sizeof(header);
+	uint64_t stationsAt = directoryAt + (uint64_t)header.NumBlocks * sizeof(ArchiveBlock);
+	uint64_t offsetsAt = stationsAt + (uint64_t)header.NumStations * sizeof(int32_t);
+	uint64_t textAt = offsetsAt + (numTexts + 1) * sizeof(uint32_t);
+
+	if (textAt + header.TextBytes > size)
+		return false;
+
+	// the dictionaries
+	const uint32_t *textOffsets = (const uint32_t *)(data + offsetsAt);
+	const char     *text = data + textAt;
+
+	this->StationIDs.assign((const int32_t *)(data + stationsAt),
+		(const int32_t *)(data + stationsAt) + header.NumStations);
+
+	this->UserTypes.clear();
+	this->Genders.clear();
+	for (uint64_t i = 0; i < numTexts; i++) {
+		if (textOffsets[i] > textOffsets[i + 1] || textOffsets[i + 1] > header.TextBytes)
+			return false;
+
+		string value(text + textOffsets[i], textOffsets[i + 1] - textOffsets[i]);
+		if (i < header.NumUserTypes)
+			this->UserTypes.push_back(value);
+		else
+			this->Genders.push_back(value);
+	}
+
+	// the blocks must fit too, and add up
+	this->Blocks = (const ArchiveBlock *)(data + directoryAt);
+	this->NumBlocks = header.NumBlocks;
+	this->NumTrips = header.NumTrips;
+
+	uint64_t numTrips = 0;
+	for (uint32_t b = 0; b < this->NumBlocks; b++) {
+		const ArchiveBlock& entry = this->Blocks[b];
+
+		if (entry.Offset > size || entry.Size > size - entry.Offset || entry.NumTrips > ArchiveBlockTrips)
+			return false;
+		numTrips += entry.NumTrips;
+	}
+
+	return numTrips == this->NumTrips;
+}
+
+
+// # of blocks
+int TripArchive::GetNumBlocks()
+{
+	return (int)this->NumBlocks;
+}
+
+
+// # of trips over all the blocks
+long long TripArchive::GetNumTrips()
+{
+	return (long long)this->NumTrips;
+}
+
+
+// the directory entry of block b
+const ArchiveBlock& TripArchive::GetBlock(int b)
+{
+	return this->Blocks[b];
+}
+
+
+//
+// the blocks that may hold trips starting in [fromTime, toTime], in
+// seconds since 1/1/2000; the others hold none.  Used by the
+// benchmark's archive scan, the loaders decode every block
+//
+vector<int> TripArchive::BlocksBetween(int fromTime, int toTime)
+{
+	vector<int> blocks;
+
+	for (uint32_t b = 0; b < this->NumBlocks; b++) {
+		if (this->Blocks[b].MinTime <= toTime && this->Blocks[b].MaxTime >= fromTime)
+			blocks.push_back((int)b);
+	}
+
+	return blocks;
+}
+
+
+//
+// Decode:
+//
+// Decodes the trips of block b into rows: the flags, trip ids, start
+// times, time buckets and stations always, the other fields (and the
+// start years) only with details, as the graph needs none of them.
+// Returns false if the block is damaged.
+//
+bool TripArchive::Decode(int b, Rows& rows, bool details)
+{
+	if (b < 0 || b >= (int)this->NumBlocks)
+		return false;
+
+	STAT_TIMER(timer, Stat::ArchiveDecode);
+
+	const ArchiveBlock& entry = this->Blocks[b];
+	const uint8_t      *block = (const uint8_t *)this->File.Data() + entry.Offset;
+	uint32_t            sizes[ArchiveColumns];
+	int                 n = (int)entry.NumTrips;
+
+	// where each column starts
+	if (entry.Size < sizeof(sizes))
+		return false;
+	memcpy(sizes, block, sizeof(sizes));
+
+	const uint8_t *columns[ArchiveColumns + 1];
+	uint64_t       at = sizeof(sizes);
+	for (int c = 0; c < ArchiveColumns; c++) {
+		columns[c] = block + at;
+		at += sizes[c];
+	}
+	if (at > entry.Size)
+		return false;
+	columns[ArchiveColumns] = block + at;
+
+	auto column = [&](int c) { return ColumnReader(columns[c], columns[c + 1]); };
+
+	rows.Resize(n, details);
+
+	// flags, run by run
+	{
+		ColumnReader flags = column(FlagsColumn);
+
+		for (int i = 0; i < n; ) {
+			uint32_t value = flags.Next();
+			uint32_t run = flags.Next();
+
+			if (run == 0 || run > (uint32_t)(n - i) || value > 0xff)
+				return false;
+
+			fill(rows.Flags.begin() + i, rows.Flags.begin() + i + run, (uint8_t)value);
+			i += (int)run;
+		}
+
+		if (!flags.Done())
+			return false;
+	}
+
+	// trip ids and start times, from their deltas
+	{
+		ColumnReader ids = column(TripIDColumn);
+		ColumnReader times = column(TimeColumn);
+		ColumnReader buckets = column(BucketColumn);
+		uint32_t     prevID = 0, prevTime = 0;
+
+		for (int i = 0; i < n; i++) {
+			uint8_t f = rows.Flags[i];
+
+			if (f & HasTripID) {
+				prevID += (uint32_t)UnZigZag(ids.Next());
+				rows.TripIDs[i] = (int32_t)prevID;
+			}
+
+			if (f & HasTime) {
+				prevTime += (uint32_t)UnZigZag(times.Next());
+
+				int t = (int32_t)prevTime;
+				if (t < 0)
+					return false;
+
+				rows.StartTimes[i] = t;
+				rows.Buckets[i] = (int16_t)TimeBucketOf(t);
+				if (details)
+					rows.StartYears[i] = (int16_t)YearOf(t);
+			}
+			else if (f & HasBucket) {
+				uint32_t bucket = buckets.Next();
+				if (bucket >= NumTimeBuckets)
+					return false;
+				rows.Buckets[i] = (int16_t)bucket;
+			}
+		}
+
+		if (!ids.Done() || !times.Done() || !buckets.Done())
+			return false;
+	}
+
+	// stations
+	{
+		ColumnReader from = column(FromColumn);
+		ColumnReader to = column(ToColumn);
+		uint32_t     numStations = (uint32_t)this->StationIDs.size();
+
+		for (int i = 0; i < n; i++) {
+			uint32_t f = from.Next(), t = to.Next();
+			if (f >= numStations || t >= numStations)
+				return false;
+
+			rows.From[i] = (int32_t)f;
+			rows.To[i] = (int32_t)t;
+		}
+
+		if (!from.Done() || !to.Done())
+			return false;
+	}
+
+	if (!details) {
+		STAT_ITEMS(timer, n);
+		return true;
+	}
+
+	// the fields only the trip store reads
+	{
+		ColumnReader bikes = column(BikeIDColumn);
+		ColumnReader durations = column(DurationColumn);
+		ColumnReader birthYears = column(BirthYearColumn);
+		ColumnReader userTypes = column(UserTypeColumn);
+		ColumnReader genders = column(GenderColumn);
+
+		for (int i = 0; i < n; i++) {
+			uint8_t f = rows.Flags[i];
+			if (!(f & HasDetail))
+				continue;
+
+			rows.BikeIDs[i] = UnZigZag(bikes.Next());
+
+			uint32_t birthYear = birthYears.Next();
+			if (birthYear != 0)
+				rows.BirthYears[i] = (int16_t)(UnZigZag(birthYear - 1) + BirthYearBase);
+
+			uint32_t userType = userTypes.Next(), gender = genders.Next();
+			if (userType >= this->UserTypes.size() || gender >= this->Genders.size())
+				return false;
+
+			rows.UserTypes[i] = (int32_t)userType;
+			rows.Genders[i] = (int32_t)gender;
+
+			if (f & HasDuration)
+				rows.Durations[i] = UnZigZag(durations.Next());
+		}
+
+		if (!bikes.Done() || !durations.Done() || !birthYears.Done() || !userTypes.Done() || !genders.Done())
+			return false;
+	}
+
+	STAT_ITEMS(timer, n);
+	return true;
+}
+
+
+//
+// the vertex of each station code, -1 for stations the index does not
+// know; one lookup per station rather than one per trip
+//
+vector<int> TripArchive::StationVertices(StationIndex& index)
+{
+	vector<int> vertices(this->StationIDs.size());
+
+	for (size_t code = 0; code < this->StationIDs.size(); code++)
+		vertices[code] = index.VertexOf(index.Find(this->StationIDs[code]));
+
+	return vertices;
+}
+
+
+// the Divvy station id of a station code
+int TripArchive::GetStationID(int code)
+{
+	return this->StationIDs[code];
+}
+
+
+// getter for the usertype dictionary
+const vector<string>& TripArchive::GetUserTypes()
+{
+	return this->UserTypes;
+}
+
+
+// getter for the gender dictionary
+const vector<string>& TripArchive::GetGenders()
+{
+	return this->Genders;
+}
+
+
+// # of bytes of the archive file
+size_t TripArchive::Size()
+{
+	return this->File.Size();
+}
@@ -0,0 +1,163 @@
+//
+// archive.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "csvscanner.h"
+#include "station.h"
+
+using namespace std;
+
+
+//
+// Compressed columnar trip archive, written once from the trips files
+// (WriteArchive()) and read in their place wherever trips files are
+// given: it holds every trip the graph and the trip store would read,
+// with duplicates dropped (see WriteArchive()), in file order.
+//
+// The trips are cut into blocks of ArchiveBlockTrips.  Within a block
+// each field is a column of its own, so a reader decodes only the
+// fields it needs:
+//   trip ids, start times		delta from the previous trip, zigzag varint
+//   from / to stations			varint code into the station id dictionary
+//   bike ids, durations		zigzag varint
+//   birth years				0 if not given, else zigzag(year - 1970) + 1, varint
+//   usertypes, genders			varint code into their dictionaries
+//   flags						which fields the trip has, run-length coded
+// Fields a trip lacks take no room in their column.  A block's entry
+// in the directory records its trips' range of start times and of
+// trip ids, so a time-range scan skips the blocks outside the range
+// (see TripArchive::BlocksBetween()).  The graph and the trip store
+// read every trip and so every block; only the benchmark scans a time
+// range for now.
+//
+// Layout (native byte order):
+//   ArchiveHeader
+//   ArchiveBlock    Blocks[NumBlocks]		directory
+//   int32_t         StationIDs[NumStations]	station code -> Divvy station id
+//   uint32_t        TextOffsets[NumUserTypes+NumGenders+1]
+//   char            Text[TextBytes]		usertypes, then genders
+//   the blocks, each: uint32_t ColumnBytes[ArchiveColumns], then the columns
+//
+// There is no checksum: decoding checks every column against the
+// block's bounds and trip count instead, so a damaged archive fails to
+// decode rather than crash.
+//
+const uint32_t ArchiveVersion = 1;
+const int      ArchiveBlockTrips = 16 * 1024;		// trips per block, the last may hold fewer
+const int      ArchiveColumns = 11;					// columns per block
+
+class ArchiveHeader
+{
+public:
+	char     Magic[8];				// "DIVVYARC"
+	uint32_t Version;				// ArchiveVersion
+	uint32_t NumBlocks;				// # of blocks
+	uint32_t NumStations;			// # of station ids in the dictionary
+	uint32_t NumUserTypes;			// # of usertype values
+	uint32_t NumGenders;			// # of gender values
+	uint32_t TextBytes;				// # of bytes of usertype and gender text
+	uint64_t NumTrips;				// # of trips over all the blocks
+};
+
+class ArchiveBlock
+{
+public:
+	uint64_t Offset;				// first byte of the block, from the start of the file
+	uint32_t Size;					// # of bytes of the block
+	uint32_t NumTrips;				// # of trips in the block
+	int32_t  MinTime, MaxTime;		// range of the start times, empty if none known
+	int32_t  MinTripID, MaxTripID;	// range of the trip ids, empty if none known
+};
+
+
+// function prototypes
+bool WriteArchive(const vector<string>& tripsFilenames, string filename, int numThreads,
+	long long& numTrips, int& duplicates);
+
+
+//
+// TripArchive class
+//
+// Reader of an archive file: maps it and decodes a block at a time.
+// Decode() may be called from any # of threads at once.
+//
+class TripArchive
+{
+public:
+
+	// which fields a trip has, see Rows::Flags
+	static const uint8_t HasTripID = 1;			// trip_id parsed
+	static const uint8_t HasTime = 2;			// starttime in 2000-2067, the time and the year
+	static const uint8_t HasBucket = 4;			// starttime outside 2000-2067, the bucket only
+	static const uint8_t HasDetail = 8;			// bike id parsed: bike id, usertype, gender, birth year
+	static const uint8_t HasDuration = 16;		// tripduration parsed, only with HasDetail
+
+	//
+	// Rows class
+	//
+	// The trips of a block, a field per vector, in file order.  A field
+	// the trip lacks (see Flags) is 0; the fields from BikeIDs on are
+	// left empty unless decoded with the details.
+	//
+	class Rows
+	{
+	public:
+		vector<uint8_t> Flags;			// Has.. bits
+		vector<int32_t> TripIDs;		// Divvy trip id
+		vector<int32_t> StartTimes;		// starttime, in seconds since 1/1/2000
+		vector<int16_t> StartYears;		// year of the starttime, only decoded with the details
+		vector<int16_t> Buckets;		// time bucket of the starttime, -1 if none
+		vector<int32_t> From;			// source station code
+		vector<int32_t> To;				// destination station code
+		vector<int32_t> BikeIDs;		// Divvy bike id
+		vector<int32_t> Durations;		// tripduration, in seconds
+		vector<int16_t> BirthYears;		// 0 if not given
+		vector<int32_t> UserTypes;		// usertype code
+		vector<int32_t> Genders;		// gender code
+
+		void Resize(size_t n, bool details);
+	};
+
+private:
+	MappedFile         File;			// the archive, mapped
+	const ArchiveBlock *Blocks;			// directory, in the mapping
+	uint32_t           NumBlocks;		// # of blocks
+	uint64_t           NumTrips;		// # of trips
+	vector<int32_t>    StationIDs;		// station code -> Divvy station id
+	vector<string>     UserTypes;		// usertype code -> text
+	vector<string>     Genders;			// gender code -> text
+
+public:
+	TripArchive();
+
+	TripArchive(const TripArchive&) = delete;
+	TripArchive& operator=(const TripArchive&) = delete;
+
+	// public function prototypes
+	static bool IsArchive(const string& filename);
+	bool Open(const string& filename);
+	int GetNumBlocks();
+	long long GetNumTrips();
+	const ArchiveBlock& GetBlock(int b);
+	vector<int> BlocksBetween(int fromTime, int toTime);
+	bool Decode(int b, Rows& rows, bool details);
+	vector<int> StationVertices(StationIndex& index);
+	int GetStationID(int code);
+	const vector<string>& GetUserTypes();
+	const vector<string>& GetGenders();
+	size_t Size();
+};
@@ -0,0 +1,122 @@
+//
+// arena.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+using namespace std;
+
+
+//
+// Arena class
+//
+// Hands out T objects carved from slabs of SlabSize objects.  Objects
+// are never freed one at a time; Release() (or the destructor) frees
+// every slab at once.  Objects can be named by their index as well as
+// their address, e.g. to link them with 32-bit indices.  Move-only.
+//
+template <typename T, size_t SlabSize = 4096>
+class Arena
+{
+private:
+	vector<unique_ptr<T[]>> Slabs;	// allocated slabs
+	size_t                  Used;	// # of objects used in the last slab
+	size_t                  Count;	// # of objects handed out
+
+public:
+	Arena()
+	{
+		this->Used = SlabSize;
+		this->Count = 0;
+	}
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	Arena(Arena&& other) noexcept
+	{
+		this->Slabs = move(other.Slabs);
+		this->Used = other.Used;
+		this->Count = other.Count;
+		other.Slabs.clear();
+		other.Used = SlabSize;
+		other.Count = 0;
+	}
+
+	Arena& operator=(Arena&& other) noexcept
+	{
+		if (this != &other) {
+			this->Slabs = move(other.Slabs);
+			this->Used = other.Used;
+			this->Count = other.Count;
+			other.Slabs.clear();
+			other.Used = SlabSize;
+			other.Count = 0;
+		}
+		return *this;
+	}
+
+	//
+	// returns a value-initialized object, grabbing a new slab when the
+	// last one is full
+	//
+	T *New()
+	{
+		if (this->Used == SlabSize) {
+			this->Slabs.push_back(unique_ptr<T[]>(new T[SlabSize]()));
+			this->Used = 0;
+		}
+
+		this->Count++;
+		return &this->Slabs.back()[this->Used++];
+	}
+
+	//
+	// frees every object handed out so far
+	//
+	void Release()
+	{
+		this->Slabs.clear();
+		this->Slabs.shrink_to_fit();
+		this->Used = SlabSize;
+		this->Count = 0;
+	}
+
+	//
+	// the i-th object handed out, i < Size(); objects are numbered in
+	// the order New() returned them
+	//
+	T& operator[](size_t i)
+	{
+		return this->Slabs[i / SlabSize][i % SlabSize];
+	}
+
+	const T& operator[](size_t i) const
+	{
+		return this->Slabs[i / SlabSize][i % SlabSize];
+	}
+
+	// # of objects handed out
+	size_t Size() const
+	{
+		return this->Count;
+	}
+
+	// # of slabs allocated
+	size_t NumSlabs() const
+	{
+		return this->Slabs.size();
+	}
+};
@@ -0,0 +1,595 @@
+//
+// benchmark.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+//
+// End-to-end benchmark: times the ingest steps and every query command
+// separately, on the real files or on ones from generate.cpp:
+//
+//   benchmark stations.csv trips.csv [queries] [threads] [seed]
+//
+// (default 1000 queries per command, one thread per core, seed 1).  The
+// trips may be several files, as for the program itself.
+// Never reads or writes a snapshot.  For each ingest step it reports the
+// time, the throughput, the # of heap allocations, the cache misses and
+// the peak RSS so far; for each command the throughput and latency
+// percentiles over queries on random stations, with the output written
+// to a string, and the cache misses per query.  The graph is also
+// rebuilt and freed a few times, as a long-running process would.  The
+// BFS and the info totals over the linked-list graph are timed before
+// freezing, for comparison with the frozen one; the trips are also
+// written to a trip archive in the temporary directory and read back
+// from it, and the od command writes its matrices there too.
+//
+// Links with everything but main.cpp:
+//
+//   g++ -std=c++17 -O2 -pthread -I. -o benchmark bench/benchmark.cpp $(ls *.cpp | grep -v main.cpp)
+//
+// The cache misses come from the hardware counters (see CacheCounter),
+// which only Linux hosts that let users read them have; elsewhere the
+// columns show "-", and the totals of the whole run are still to be had
+// with
+//
+//   perf stat -e cache-misses,L1-dcache-load-misses ./benchmark stations.csv trips.csv
+//
+
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <filesystem>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "archive.h"
+#include "bfs.h"
+#include "graph.h"
+#include "odmatrix.h"
+#include "ingest.h"
+#include "path.h"
+#include "queries.h"
+#include "spatial.h"
+#include "station.h"
+#include "timebuckets.h"
+#include "tripfiles.h"
+#include "tripstore.h"
+
+using namespace std;
+
+
+//
+// every heap allocation is counted, to compare the allocation behavior
+// of the ingest steps (gcc cannot tell the replacements below pair up)
+//
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+static atomic<long long> NumAllocations(0);
+
+void *operator new(size_t size)
+{
+	NumAllocations.fetch_add(1, memory_order_relaxed);
+
+	void *p = malloc(size == 0 ? 1 : size);
+	if (p == nullptr)
+		throw bad_alloc();
+	return p;
+}
+
+void operator delete(void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	free(p);
+}
+
+
+//
+// peak resident set size of the process so far, in MB
+//
+static double PeakRSS()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+	return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+	return usage.ru_maxrss / (1024.0 * 1024.0);		// bytes
+#else
+	return usage.ru_maxrss / 1024.0;				// kilobytes
+#endif
+#endif
+}
+
+
+//
+// CacheCounter class
+//
+// Counts the cache misses of the process from the hardware performance
+// counters: last-level cache misses and L1 data cache read misses, of
+// the main thread and of every thread it started and joined since.
+// Read() returns the totals so far, so a step's misses are the
+// difference of two reads.  Linux only, and only where the counters
+// are open to users (perf_event_paranoid at most 2, and real hardware
+// or a VM that passes them on); elsewhere Available() is false.
+//
+class CacheCounter
+{
+private:
+	int Fds[2];						// last level, L1 data; -1 if not open
+
+public:
+	CacheCounter()
+	{
+		this->Fds[0] = this->Fds[1] = -1;
+
+#ifdef __linux__
+		const uint64_t configs[2] = {
+			PERF_COUNT_HW_CACHE_MISSES,
+			PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+		};
+		const uint32_t types[2] = { PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE };
+
+		for (int c = 0; c < 2; c++) {
+			struct perf_event_attr attr;
+			memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = types[c];
+			attr.config = configs[c];
+			attr.inherit = 1;			// threads started later count too
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+
+			this->Fds[c] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+		}
+#endif
+	}
+
+	~CacheCounter()
+	{
+#ifdef __linux__
+		for (int fd : this->Fds) {
+			if (fd != -1)
+				close(fd);
+		}
+#endif
+	}
+
+	CacheCounter(const CacheCounter&) = delete;
+	CacheCounter& operator=(const CacheCounter&) = delete;
+
+	bool Available()
+	{
+		return this->Fds[0] != -1 && this->Fds[1] != -1;
+	}
+
+	// the last-level and L1 data misses so far, 0 if not available
+	void Read(long long& lastLevel, long long& l1)
+	{
+		lastLevel = l1 = 0;
+
+#ifdef __linux__
+		uint64_t value;
+		if (this->Fds[0] != -1 && read(this->Fds[0], &value, sizeof(value)) == sizeof(value))
+			lastLevel = (long long)value;
+		if (this->Fds[1] != -1 && read(this->Fds[1], &value, sizeof(value)) == sizeof(value))
+			l1 = (long long)value;
+#endif
+	}
+};
+
+static CacheCounter CacheMisses;
+
+
+//
+// a # of cache misses for a column: in thousands or millions, "-" if
+// there are no counters
+//
+static string Misses(double n)
+{
+	char text[32];
+
+	if (!CacheMisses.Available())
+		return "-";
+	if (n >= 1e6)
+		snprintf(text, sizeof(text), "%.1fM", n / 1e6);
+	else if (n >= 1e3)
+		snprintf(text, sizeof(text), "%.1fK", n / 1e3);
+	else
+		snprintf(text, sizeof(text), "%.0f", n);
+	return text;
+}
+
+
+// seconds since the given time
+static double Since(chrono::steady_clock::time_point start)
+{
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+
+//
+// times one ingest step and prints its line: time, rate of the given
+// # of items, allocations and last-level / L1 data cache misses during
+// the step, and peak RSS so far
+//
+static void TimeStep(string name, function<void()> step, function<double()> items, string unit)
+{
+	long long allocations = NumAllocations;
+	long long lastLevel, l1, lastLevelEnd, l1End;
+
+	CacheMisses.Read(lastLevel, l1);
+	auto start = chrono::steady_clock::now();
+
+	step();
+
+	double seconds = Since(start);
+	CacheMisses.Read(lastLevelEnd, l1End);
+
+	double rate = (seconds > 0) ? items() / seconds : 0.0;
+	char   line[256];
+
+	snprintf(line, sizeof(line), "%-18s %10.1f ms %14.0f %-10s %12lld allocs %8s LLC %8s L1D %9.1f MB",
+		name.c_str(), seconds * 1000, rate, (unit + "/s").c_str(), NumAllocations - allocations,
+		Misses((double)(lastLevelEnd - lastLevel)).c_str(), Misses((double)(l1End - l1)).c_str(), PeakRSS());
+	cout << line << endl;
+}
+
+
+//
+// runs a query per line of queries through RunQuery, timing each one,
+// and prints the throughput, the latency percentiles and the last-level
+// / L1 data cache misses per query
+//
+static void TimeQueries(string name, vector<string>& queries, Graph& G, vector<Station>& stations,
+	StationIndex& index, TimeBuckets& buckets, TripStore& trips, ODMatrix& od, PathEngine& paths, SpatialIndex& spatial)
+{
+	vector<double> latency;
+	ostringstream  out;
+	size_t         bytes = 0;
+
+	long long lastLevel, l1, lastLevelEnd, l1End;
+
+	latency.reserve(queries.size());
+	CacheMisses.Read(lastLevel, l1);
+	auto start = chrono::steady_clock::now();
+
+	for (string& q : queries) {
+		auto begin = chrono::steady_clock::now();
+
+		out.str("");
+		RunQuery(out, q, G, stations, index, buckets, trips, od, paths, spatial);
+		bytes += (size_t)out.tellp();
+
+		latency.push_back(Since(begin) * 1e6);
+	}
+
+	double seconds = Since(start);
+	CacheMisses.Read(lastLevelEnd, l1End);
+	sort(latency.begin(), latency.end());
+
+	double numQueries = (double)max(queries.size(), (size_t)1);
+
+	auto percentile = [&](double p) {
+		return latency.empty() ? 0.0 : latency[min(latency.size() - 1, (size_t)(p * latency.size()))];
+	};
+
+	char line[256];
+	snprintf(line, sizeof(line), "%-18s %8zu %12.0f q/s %10.1f %10.1f %10.1f %10.1f us %8s %8s %9.1f MB out",
+		name.c_str(), queries.size(), (seconds > 0) ? queries.size() / seconds : 0.0,
+		percentile(0.50), percentile(0.90), percentile(0.99), latency.empty() ? 0.0 : latency.back(),
+		Misses((lastLevelEnd - lastLevel) / numQueries).c_str(), Misses((l1End - l1) / numQueries).c_str(),
+		bytes / (1024.0 * 1024.0));
+	cout << line << endl;
+}
+
+
+// main
+int main(int argc, char *argv[])
+{
+	if (argc < 3) {
+		cerr << "usage: benchmark stations.csv trips.csv [queries] [threads] [seed]" << endl;
+		return 1;
+	}
+
+	string         stationsFilename = argv[1];
+	vector<string> tripsFilenames = ExpandTripFiles(argv[2]);
+	int            numQueries = (argc >= 4) ? atoi(argv[3]) : 1000;
+	int            numThreads = (argc >= 5) ? atoi(argv[4]) : (int)thread::hardware_concurrency();
+	unsigned seed = (argc >= 6) ? (unsigned)atoi(argv[5]) : 1;
+
+	error_code error;
+	double     stationsBytes = (double)filesystem::file_size(stationsFilename, error);
+	double     tripsBytes = 0;
+	for (string& filename : tripsFilenames) {
+		tripsBytes += (double)filesystem::file_size(filename, error);
+		if (error) {
+			cerr << "**Error: unable to open '" << filename << "'" << endl;
+			return 1;
+		}
+	}
+	if (tripsFilenames.empty()) {
+		cerr << "**Error: no trips files match '" << argv[2] << "'" << endl;
+		return 1;
+	}
+
+	numThreads = max(numThreads, 1);
+
+	cout << "** Divvy Graph Analysis benchmark **" << endl;
+	cout << "   threads: " << numThreads << ", queries per command: " << numQueries << endl;
+
+	Graph             G(max(1000, CountRecords(stationsFilename)));
+	StationIndex      index;
+	vector<Station>   stations;
+	TimeBucketCounter bucketCounter;
+	TimeBuckets       buckets;
+
+	//
+	// ingest
+	//
+	TimeStep("InputStations", [&]() { stations = InputStations(G, stationsFilename, index); },
+		[&]() { return stationsBytes / (1024 * 1024); }, "MB");
+	int duplicates = 0;
+	TimeStep("ProcessTrips", [&]() { duplicates = ProcessTrips(tripsFilenames, G, index, numThreads, bucketCounter); },
+		[&]() { return tripsBytes / (1024 * 1024); }, "MB");
+
+	cout << "   " << tripsFilenames.size() << " trips files, " << duplicates << " duplicate trips dropped" << endl;
+	cout << "   " << stations.size() << " stations, " << G.GetNumVertices() << " vertices, "
+		<< G.GetNumEdges() << " edges" << endl;
+
+	// a long-running process building its graph over and over: the edges
+	// come out of the graph's arena, so a rebuild takes as many
+	// allocations as the first build, and destroying the graph gives all
+	// its memory back: the peak RSS grows by one graph (the one alive
+	// next to G), not by one per rebuild
+	const int numRebuilds = 2;
+	TimeStep("Rebuild + free", [&]() {
+		for (int r = 0; r < numRebuilds; r++) {
+			Graph             rebuilt(max(1000, CountRecords(stationsFilename)));
+			StationIndex      rebuiltIndex;
+			TimeBucketCounter rebuiltBuckets;
+			vector<Station>   rebuiltStations = InputStations(rebuilt, stationsFilename, rebuiltIndex);
+
+			ProcessTrips(tripsFilenames, rebuilt, rebuiltIndex, numThreads, rebuiltBuckets);
+		}
+	}, [&]() { return numRebuilds * tripsBytes / (1024 * 1024); }, "MB");
+
+	// BFS from a sample of vertices, the same ones before and after freezing
+	mt19937 rng(seed);
+	vector<int> starts;
+	for (int i = 0; i < min(numQueries, 100) && G.GetNumVertices() > 0; i++)
+		starts.push_back((int)(rng() % G.GetNumVertices()));
+
+	long long visited = 0;
+	TimeStep("BFS (lists)", [&]() { for (int s : starts) visited += G.BFS(s).size(); },
+		[&]() { return (double)visited; }, "vertices");
+
+	// the walk info does over a station's routes, for every station
+	long long edgesWalked = 0, tripsSeen = 0;
+	auto infoWalk = [&]() {
+		for (int v = 0; v < G.GetNumVertices(); v++) {
+			for (Graph::Neighbor n : G.Neighbors(v)) {
+				tripsSeen += n.Weight;
+				edgesWalked++;
+			}
+		}
+	};
+
+	TimeStep("Info (lists)", infoWalk, [&]() { return (double)edgesWalked; }, "edges");
+
+	TimeStep("Freeze", [&]() { G.Freeze(); },
+		[&]() { return (double)G.GetNumEdges(); }, "edges");
+	TimeStep("TimeBuckets", [&]() { buckets.Build(G, bucketCounter); },
+		[&]() { return (double)bucketCounter.GetEntries().size(); }, "entries");
+
+	visited = 0;
+	TimeStep("BFS (CSR)", [&]() { for (int s : starts) visited += G.BFS(s).size(); },
+		[&]() { return (double)visited; }, "vertices");
+
+	edgesWalked = 0;
+	TimeStep("Info (CSR)", infoWalk, [&]() { return (double)edgesWalked; }, "edges");
+
+	BFSEngine engine(G);
+	visited = 0;
+	TimeStep("BFSEngine", [&]() { for (int s : starts) visited += engine.Run(s, numThreads).size(); },
+		[&]() { return (double)visited; }, "vertices");
+
+	TripStore trips;
+	TimeStep("TripStore", [&]() { trips.Load(tripsFilenames, G, index, numThreads); },
+		[&]() { return tripsBytes / (1024 * 1024); }, "MB");
+
+	//
+	// the same trips as an archive: writing it, reading the graph from
+	// it (rated by the CSV bytes it stands for, to compare with
+	// ProcessTrips) and a scan of its last 30 days
+	//
+	string    archiveFilename = (filesystem::temp_directory_path(error) / "benchmark.dva").string();
+	long long archivedTrips = 0;
+	int       archiveDuplicates = 0;
+
+	TimeStep("WriteArchive", [&]() { WriteArchive(tripsFilenames, archiveFilename, numThreads, archivedTrips, archiveDuplicates); },
+		[&]() { return tripsBytes / (1024 * 1024); }, "MB");
+
+	double archiveBytes = (double)filesystem::file_size(archiveFilename, error);
+	if (!error) {
+		cout << "   " << archivedTrips << " trips, " << archiveBytes / (1024 * 1024) << " MB, "
+			<< tripsBytes / max(archiveBytes, 1.0) << "x smaller than the trips files" << endl;
+
+		Graph             archiveGraph(max(1000, CountRecords(stationsFilename)));
+		StationIndex      archiveIndex;
+		TimeBucketCounter archiveBuckets;
+		vector<Station>   archiveStations = InputStations(archiveGraph, stationsFilename, archiveIndex);
+
+		TimeStep("ProcessTrips (dva)", [&]() { ProcessTrips({ archiveFilename }, archiveGraph, archiveIndex, numThreads, archiveBuckets); },
+			[&]() { return tripsBytes / (1024 * 1024); }, "MB");
+		cout << "   " << archiveGraph.GetNumEdges() << " edges" << endl;
+
+		TripArchive archive;
+		long long   scanned = 0;
+		if (archive.Open(archiveFilename) && archive.GetNumBlocks() > 0) {
+			int last = archive.GetBlock(archive.GetNumBlocks() - 1).MaxTime;
+
+			TimeStep("Archive scan", [&]() {
+				TripArchive::Rows rows;
+				for (int b : archive.BlocksBetween(last - 30 * 86400, last)) {
+					if (archive.Decode(b, rows, false))
+						scanned += rows.Flags.size();
+				}
+			}, [&]() { return (double)scanned; }, "trips");
+		}
+	}
+	filesystem::remove(archiveFilename, error);
+
+	SpatialIndex spatial;
+	TimeStep("SpatialIndex", [&]() { spatial.Build(stations); },
+		[&]() { return (double)stations.size(); }, "stations");
+
+	ODMatrix od;
+	TimeStep("ODMatrix", [&]() { od.Build(G); },
+		[&]() { return (double)G.GetNumEdges(); }, "edges");
+
+	if (stations.empty())
+		return 0;
+
+	//
+	// queries, on random stations
+	//
+	PathEngine paths(G, stations, index);
+
+	auto station = [&]() {
+		return to_string(stations[rng() % stations.size()].ID);
+	};
+
+	cout << endl;
+	cout << "command             queries   throughput        p50        p90        p99        max    LLC/q    L1D/q" << endl;
+
+	vector<string> queries;
+	for (int i = 0; i < numQueries; i++)
+		queries.push_back("info " + station());
+	TimeQueries("info", queries, G, stations, index, buckets, trips, od, paths, spatial);
+
+	queries.clear();
+	for (int i = 0; i < numQueries; i++)
+		queries.push_back("info " + station() + " weekday hour 8");
+	TimeQueries("info (filtered)", queries, G, stations, index, buckets, trips, od, paths, spatial);
+
+	queries.clear();
+	for (int i = 0; i < numQueries; i++)
+		queries.push_back("arrivals " + station());
+	TimeQueries("arrivals", queries, G, stations, index, buckets, trips, od, paths, spatial);
+
+	queries.clear();
+	for (int i = 0; i < numQueries; i++)
+		queries.push_back("trips " + station() + " " + station());
+	TimeQueries("trips", queries, G, stations, index, buckets, trips, od, paths, spatial);
+
+	queries.clear();
+	for (int i = 0; i < numQueries; i++)
+		queries.push_back("bfs " + station());
+	TimeQueries("bfs", queries, G, stations, index, buckets, trips, od, paths, spatial);
+
+	queries.clear();
+	for (int i = 0; i < numQueries; i++)
+		queries.push_back("component " + station());
+	TimeQueries("component", queries, G, stations, index, buckets, trips, od, paths, spatial);
+
+	queries.assign(min(numQueries, 20), "components");
+	TimeQueries("components", queries, G, stations, index, buckets, trips, od, paths, spatial);
+
+	queries.clear();
+	for (int i = 0; i < numQueries; i++)
+		queries.push_back("path " + station() + " " + station());
+	TimeQueries("path", queries, G, stations, index, buckets, trips, od, paths, spatial);
+
+	queries.clear();
+	for (int i = 0; i < numQueries; i++)
+		queries.push_back("durations " + station() + " " + station());
+	TimeQueries("durations", queries, G, stations, index, buckets, trips, od, paths, spatial);
+
+	queries.clear();
+	for (int i = 0; i < numQueries; i++)
+		queries.push_back("riders " + station());
+	TimeQueries("riders", queries, G, stations, index, buckets, trips, od, paths, spatial);
+
+	queries.clear();
+	for (int i = 0; i < numQueries; i++)
+		queries.push_back("ages " + station() + " weekday");
+	TimeQueries("ages (filtered)", queries, G, stations, index, buckets, trips, od, paths, spatial);
+
+	queries.clear();
+	for (int i = 0; i < numQueries; i++)
+		queries.push_back("moves " + station());
+	TimeQueries("moves", queries, G, stations, index, buckets, trips, od, paths, spatial);
+
+	queries.assign(min(numQueries, 20), "rebalancing 10");
+	TimeQueries("rebalancing", queries, G, stations, index, buckets, trips, od, paths, spatial);
+
+	queries.clear();
+	for (int i = 0; i < min(numQueries, 100); i++)
+		queries.push_back("imbalance " + to_string(rng() % 24));
+	TimeQueries("imbalance", queries, G, stations, index, buckets, trips, od, paths, spatial);
+
+	// the block of a neighborhood, written to a temporary file: od takes
+	// a plain filename, in the export directory
+	string exportDir = filesystem::temp_directory_path(error).string();
+	string odFilename = (filesystem::path(exportDir) / "benchmark.odm").string();
+#ifdef _WIN32
+	_putenv_s("DIVVY_EXPORT_DIR", exportDir.c_str());
+#else
+	setenv("DIVVY_EXPORT_DIR", exportDir.c_str(), 1);
+#endif
+	queries.clear();
+	for (int i = 0; i < numQueries; i++)
+		queries.push_back("od benchmark.odm within " + station() + " 2000");
+	TimeQueries("od (within)", queries, G, stations, index, buckets, trips, od, paths, spatial);
+
+	// the whole matrix, a few runs are enough
+	queries.assign(min(numQueries, 5), "od benchmark.odm");
+	TimeQueries("od", queries, G, stations, index, buckets, trips, od, paths, spatial);
+	filesystem::remove(odFilename, error);
+
+	// the whole graph each time, a few runs are enough
+	queries.assign(min(numQueries, 5), "debug");
+	TimeQueries("debug", queries, G, stations, index, buckets, trips, od, paths, spatial);
+
+	cout << endl;
+	cout << "peak RSS: " << PeakRSS() << " MB" << endl;
+	return 0;
+}
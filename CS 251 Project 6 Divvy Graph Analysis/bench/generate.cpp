@@ -0,0 +1,407 @@
+//
+// generate.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+//
+// Synthetic Divvy data generator, writes a stations file and a trips file
+// in the format of the real ones, at any scale:
+//
+//   generate stations.csv trips.csv [stations] [trips] [days] [seed]
+//
+// (default 10000 stations, 1000000 trips over 30 days from 6/1/2016,
+// seed 1).  Stations sit on a jittered grid over the Chicago area,
+// with a Zipf-skewed popularity.  Trips start at popular stations and
+// mostly end at nearby ones, favoring popular ones about as much as the
+// starts do, so bikes do not pile up; they follow a morning / evening
+// rush hour profile and are written in time order.  Bikes are tracked,
+// so a bike usually starts where its last trip ended, except when it
+// had to be moved.
+//
+// Stand-alone, only needs geo.h:
+//
+//   g++ -std=c++17 -O2 -o generate bench/generate.cpp
+//
+
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../geo.h"
+
+using namespace std;
+
+
+//
+// Writer class
+//
+// Buffered output file, with formatting of the few field types the
+// files need.
+//
+class Writer
+{
+private:
+	FILE        *File;
+	vector<char> Buffer;
+
+public:
+	Writer(string filename)
+	{
+		this->File = fopen(filename.c_str(), "wb");
+		this->Buffer.reserve(1 << 20);
+	}
+
+	~Writer()
+	{
+		this->Flush();
+		if (this->File != nullptr)
+			fclose(this->File);
+	}
+
+	bool IsOpen()
+	{
+		return this->File != nullptr;
+	}
+
+	void Flush()
+	{
+		if (this->File != nullptr && !this->Buffer.empty())
+			fwrite(this->Buffer.data(), 1, this->Buffer.size(), this->File);
+		this->Buffer.clear();
+	}
+
+	void Put(const char *s, size_t n)
+	{
+		this->Buffer.insert(this->Buffer.end(), s, s + n);
+		if (this->Buffer.size() >= (1 << 20) - 256)
+			this->Flush();
+	}
+
+	void Put(const string& s)
+	{
+		this->Put(s.data(), s.size());
+	}
+
+	void Put(char c)
+	{
+		this->Put(&c, 1);
+	}
+
+	void Put(long long n)
+	{
+		char  digits[24];
+		char *p = digits + sizeof(digits);
+		bool  negative = n < 0;
+		unsigned long long u = negative ? 0ull - (unsigned long long)n : (unsigned long long)n;
+
+		do {
+			*--p = (char)('0' + u % 10);
+			u /= 10;
+		} while (u != 0);
+		if (negative)
+			*--p = '-';
+
+		this->Put(p, digits + sizeof(digits) - p);
+	}
+};
+
+
+//
+// civil date of the given day, counting from 1/1/1970
+//
+static void CivilFromDays(long long days, int& year, int& month, int& day)
+{
+	days += 719468;
+	long long era = (days >= 0 ? days : days - 146096) / 146097;
+	long long doe = days - era * 146097;
+	long long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	long long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	long long mp = (5 * doy + 2) / 153;
+
+	day = (int)(doy - (153 * mp + 2) / 5 + 1);
+	month = (int)(mp < 10 ? mp + 3 : mp - 9);
+	year = (int)(yoe + era * 400 + (month <= 2 ? 1 : 0));
+}
+
+
+//
+// writes a time, in seconds since 1/1/1970, as "6/30/2016 23:35"
+//
+static void PutTime(Writer& out, long long seconds)
+{
+	int year, month, day;
+	CivilFromDays(seconds / 86400, year, month, day);
+
+	int minute = (int)(seconds % 86400 / 60);
+
+	out.Put((long long)month);
+	out.Put('/');
+	out.Put((long long)day);
+	out.Put('/');
+	out.Put((long long)year);
+	out.Put(' ');
+	out.Put((long long)(minute / 60));
+	out.Put(':');
+	out.Put((char)('0' + minute % 60 / 10));
+	out.Put((char)('0' + minute % 10));
+}
+
+
+// "1st", "2nd", "3rd", "4th", ..., "11th", ..., "21st"
+static string Ordinal(int n)
+{
+	const char *suffix = "th";
+
+	if (n % 100 < 11 || n % 100 > 13) {
+		if (n % 10 == 1)
+			suffix = "st";
+		else if (n % 10 == 2)
+			suffix = "nd";
+		else if (n % 10 == 3)
+			suffix = "rd";
+	}
+
+	return to_string(n) + suffix;
+}
+
+
+// main
+int main(int argc, char *argv[])
+{
+	if (argc < 3) {
+		cerr << "usage: generate stations.csv trips.csv [stations] [trips] [days] [seed]" << endl;
+		return 1;
+	}
+
+	int       numStations = (argc >= 4) ? atoi(argv[3]) : 10000;
+	long long numTrips = (argc >= 5) ? atoll(argv[4]) : 1000000;
+	int       numDays = (argc >= 6) ? atoi(argv[5]) : 30;
+	unsigned  seed = (argc >= 7) ? (unsigned)atoi(argv[6]) : 1;
+
+	if (numStations < 1 || numTrips < 0 || numDays < 1) {
+		cerr << "**Error: bad sizes" << endl;
+		return 1;
+	}
+
+	mt19937_64 rng(seed);
+	uniform_real_distribution<double> uniform(0.0, 1.0);
+
+	//
+	// stations: a jittered grid over the Chicago area, row-major, so
+	// grid neighbors are geographic neighbors
+	//
+	int    side = (int)ceil(sqrt((double)numStations));
+	double minLat = 41.65, maxLat = 42.07;
+	double minLon = -87.85, maxLon = -87.52;
+	double stepLat = (maxLat - minLat) / side;
+	double stepLon = (maxLon - minLon) / side;
+
+	vector<int>    ids(numStations);
+	vector<string> names(numStations);
+	vector<double> latitude(numStations), longitude(numStations);
+
+	for (int i = 0; i < numStations; i++) {
+		int row = i / side, col = i % side;
+
+		ids[i] = i + i / 2 + 2;				// increasing, with gaps like the real ids
+		names[i] = "W " + Ordinal(row + 1) + " St & N " + Ordinal(col + 1) + " Ave";
+		latitude[i] = minLat + (row + 0.2 + 0.6 * uniform(rng)) * stepLat;
+		longitude[i] = minLon + (col + 0.2 + 0.6 * uniform(rng)) * stepLon;
+	}
+
+	// Zipf popularity over a random order of the stations
+	vector<int> byRank(numStations);
+	for (int i = 0; i < numStations; i++)
+		byRank[i] = i;
+	shuffle(byRank.begin(), byRank.end(), rng);
+
+	vector<double> rankCdf(numStations);
+	double sum = 0.0;
+	for (int r = 0; r < numStations; r++) {
+		sum += pow(r + 1.0, -0.7);
+		rankCdf[r] = sum;
+	}
+	for (double& c : rankCdf)
+		c /= sum;
+
+	vector<int> rankOf(numStations);
+	for (int r = 0; r < numStations; r++)
+		rankOf[byRank[r]] = r;
+
+	auto popularStation = [&]() {
+		int r = (int)(lower_bound(rankCdf.begin(), rankCdf.end(), uniform(rng)) - rankCdf.begin());
+		return byRank[min(r, numStations - 1)];
+	};
+
+	{
+		Writer out(argv[1]);
+		if (!out.IsOpen()) {
+			cerr << "**Error: unable to open '" << argv[1] << "'" << endl;
+			return 1;
+		}
+
+		out.Put(string("id,name,latitude,longitude,dpcapacity,online_date\n"));
+
+		for (int i = 0; i < numStations; i++) {
+			// the popular stations are the big ones
+			int capacity = (rankOf[i] < numStations / 20) ? 31 + (int)(uniform(rng) * 25) : 11 + 4 * (int)(uniform(rng) * 5);
+			char coordinates[64];
+			int  n = snprintf(coordinates, sizeof(coordinates), "%.6f,%.6f", latitude[i], longitude[i]);
+
+			out.Put((long long)ids[i]);
+			out.Put(',');
+			out.Put(names[i]);
+			out.Put(',');
+			out.Put(coordinates, n);
+			out.Put(',');
+			out.Put((long long)capacity);
+			out.Put(string(",6/10/2013\n"));
+		}
+	}
+
+	//
+	// bikes, about 10 per station, each parked at a station; the bikes
+	// at a station are kept in a list, with each bike's place in it
+	//
+	int numBikes = numStations * 10;
+	vector<vector<int>> parked(numStations);
+	vector<int> bikeAt(numBikes), bikeSlot(numBikes);
+
+	auto park = [&](int bike, int station) {
+		bikeAt[bike] = station;
+		bikeSlot[bike] = (int)parked[station].size();
+		parked[station].push_back(bike);
+	};
+	auto unpark = [&](int bike) {
+		vector<int>& list = parked[bikeAt[bike]];
+		int last = list.back();
+
+		list[bikeSlot[bike]] = last;
+		bikeSlot[last] = bikeSlot[bike];
+		list.pop_back();
+	};
+
+	for (int b = 0; b < numBikes; b++)
+		park(b, b % numStations);
+
+	// share of the day's trips by start hour: rush hours at 8 and 17
+	static const double hourWeight[24] = {
+		0.8, 0.5, 0.3, 0.2, 0.2, 0.5, 1.5, 3.5, 6.0, 4.0, 3.0, 3.5,
+		4.0, 4.0, 4.0, 4.5, 6.0, 8.0, 7.0, 5.0, 3.5, 2.5, 2.0, 1.2 };
+	double hourCdf[25] = { 0.0 };
+	for (int h = 0; h < 24; h++)
+		hourCdf[h + 1] = hourCdf[h] + hourWeight[h];
+	for (int h = 0; h <= 24; h++)
+		hourCdf[h] /= hourCdf[24];
+
+	// destination offsets on the grid, in cells
+	geometric_distribution<int> reach(0.3);
+
+	//
+	// trips, in time order
+	//
+	const long long startTime = 16953LL * 86400;		// 6/1/2016
+	long long tripsPerDay = max(1LL, (numTrips + numDays - 1) / numDays);
+	long long moved = 0;
+
+	Writer out(argv[2]);
+	if (!out.IsOpen()) {
+		cerr << "**Error: unable to open '" << argv[2] << "'" << endl;
+		return 1;
+	}
+
+	out.Put(string("trip_id,starttime,stoptime,bikeid,tripduration,from_station_id,from_station_name,"
+		"to_station_id,to_station_name,usertype,gender,birthyear\n"));
+
+	for (long long t = 0; t < numTrips; t++) {
+		// start time: the trip's share of its day, through the hour profile
+		long long day = t / tripsPerDay;
+		double    u = (double)(t % tripsPerDay) / tripsPerDay;
+		int       h = (int)(upper_bound(hourCdf, hourCdf + 25, u) - hourCdf) - 1;
+		double    inHour = (u - hourCdf[h]) / (hourCdf[h + 1] - hourCdf[h]);
+		long long start = startTime + day * 86400 + h * 3600 + (long long)(inHour * 3600);
+
+		// from a popular station, mostly to one close by
+		int src = popularStation();
+		int dest;
+
+		if (uniform(rng) < 0.1) {
+			dest = popularStation();
+		}
+		else {
+			// a nearby station, kept with probability min(1, its popularity
+			// relative to src) so the flows both ways roughly match
+			int row = src / side, col = src % side;
+			for (int tries = 0; ; tries++) {
+				int dr = reach(rng) * (uniform(rng) < 0.5 ? -1 : 1);
+				int dc = reach(rng) * (uniform(rng) < 0.5 ? -1 : 1);
+				dest = (row + dr) * side + (col + dc);
+				if (row + dr < 0 || col + dc < 0 || col + dc >= side || dest >= numStations)
+					continue;
+				if (tries >= 20 || uniform(rng) < pow((rankOf[src] + 1.0) / (rankOf[dest] + 1.0), 0.7))
+					break;
+			}
+		}
+
+		// a bike parked there, or one moved in from elsewhere
+		int bike;
+		if (!parked[src].empty()) {
+			bike = parked[src].back();
+		}
+		else {
+			bike = (int)(uniform(rng) * numBikes);
+			moved++;
+		}
+		unpark(bike);
+		park(bike, dest);
+
+		// riding at about 3.5 m/s, round trips take a while
+		double meters = Haversine(latitude[src], longitude[src], latitude[dest], longitude[dest]);
+		long long duration = (src == dest) ? 600 + (long long)(uniform(rng) * 3000)
+			: 120 + (long long)(meters / 3.5 * (1.0 + 0.5 * uniform(rng)));
+
+		bool subscriber = uniform(rng) < 0.75;
+
+		out.Put(t + 1);
+		out.Put(',');
+		PutTime(out, start);
+		out.Put(',');
+		PutTime(out, start + duration);
+		out.Put(',');
+		out.Put((long long)(bike + 1));
+		out.Put(',');
+		out.Put(duration);
+		out.Put(',');
+		out.Put((long long)ids[src]);
+		out.Put(',');
+		out.Put(names[src]);
+		out.Put(',');
+		out.Put((long long)ids[dest]);
+		out.Put(',');
+		out.Put(names[dest]);
+		if (subscriber) {
+			out.Put(string(uniform(rng) < 0.7 ? ",Subscriber,Male," : ",Subscriber,Female,"));
+			out.Put((long long)(1950 + (int)(uniform(rng) * 49)));
+			out.Put('\n');
+		}
+		else {
+			out.Put(string(",Customer,,\n"));
+		}
+	}
+
+	cerr << numStations << " stations, " << numTrips << " trips, " << moved << " bikes moved" << endl;
+	return 0;
+}
@@ -0,0 +1,230 @@
+//
+// bfs.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#include <algorithm>
+#include <thread>
+
+#include "bfs.h"
+
+using namespace std;
+
+
+// direction switching thresholds, as suggested by Beamer et al.
+static const int Alpha = 14;		// go bottom-up when frontier edges > unexplored edges / Alpha
+static const int Beta = 24;			// go top-down when frontier size < # of vertices / Beta
+
+// below this many items per level a step is not worth splitting
+static const int MinParallelWork = 4096;
+
+
+//
+// runs fn(t, begin, end) over [0, n) split into numThreads contiguous
+// ranges; the range boundaries are multiples of align
+//
+template <typename Fn>
+static void ParallelFor(int n, int numThreads, int align, Fn fn)
+{
+	if (numThreads <= 1 || n < MinParallelWork) {
+		fn(0, 0, n);
+		return;
+	}
+
+	vector<thread> workers;
+	int chunk = ((n / numThreads + align - 1) / align) * align;
+
+	for (int t = 0; t < numThreads; t++) {
+		int begin = min(n, t * chunk);
+		int end = (t == numThreads - 1) ? n : min(n, begin + chunk);
+		workers.push_back(thread(fn, t, begin, end));
+	}
+
+	for (thread& w : workers)
+		w.join();
+}
+
+
+//
+// Constructor:
+//
+BFSEngine::BFSEngine(Graph& G)
+	: G(G)
+{
+	this->NumVertices = G.GetNumVertices();
+	this->NumWords = (this->NumVertices + 63) / 64;
+	this->Visited.reset(new atomic<uint64_t>[this->NumWords]);
+	this->NumTopDownSteps = 0;
+	this->NumBottomUpSteps = 0;
+}
+
+
+//
+// expands the frontier along out-edges into Next, returns the # of
+// edges scanned
+//
+long long BFSEngine::TopDown(int numThreads)
+{
+	const vector<int>& offsets = this->G.GetOffsets();
+	const vector<Graph::VertexType>& dests = this->G.GetDests();
+
+	int n = (int)this->Frontier.size();
+	int threads = (n < MinParallelWork) ? 1 : numThreads;
+	vector<vector<int>> local(max(threads, 1));
+	vector<long long>   scanned(max(threads, 1), 0);
+
+	ParallelFor(n, threads, 1, [&](int t, int begin, int end) {
+		for (int i = begin; i < end; i++) {
+			int u = this->Frontier[i];
+
+			for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+				int v = dests[e];
+				uint64_t bit = 1ull << (v & 63);
+
+				// claim v; only the thread that sets the bit adds it
+				if (this->Visited[v >> 6].load(memory_order_relaxed) & bit)
+					continue;
+				if (!(this->Visited[v >> 6].fetch_or(bit, memory_order_relaxed) & bit))
+					local[t].push_back(v);
+			}
+
+			scanned[t] += offsets[u + 1] - offsets[u];
+		}
+	});
+
+	long long total = 0;
+	for (size_t t = 0; t < local.size(); t++) {
+		this->Next.insert(this->Next.end(), local[t].begin(), local[t].end());
+		total += scanned[t];
+	}
+
+	// same level order whatever the thread count
+	sort(this->Next.begin(), this->Next.end());
+	return total;
+}
+
+
+//
+// checks every unvisited vertex for an in-edge from the frontier,
+// collecting the hits into Next in ascending order
+//
+void BFSEngine::BottomUp(int numThreads)
+{
+	// in-edges from the graph's reverse adjacency
+	const vector<int>& inOffsets = this->G.GetInOffsets();
+	const vector<Graph::VertexType>& inSources = this->G.GetInSources();
+
+	// frontier as a bitmap
+	this->FrontierBits.assign(this->NumWords, 0);
+	for (int u : this->Frontier)
+		this->FrontierBits[u >> 6] |= 1ull << (u & 63);
+
+	int threads = max(numThreads, 1);
+	vector<vector<int>> local(threads);
+
+	// ranges are whole bitmap words, so each word has a single writer
+	ParallelFor(this->NumVertices, threads, 64, [&](int t, int begin, int end) {
+		for (int v = begin; v < end; v++) {
+			uint64_t bit = 1ull << (v & 63);
+			if (this->Visited[v >> 6].load(memory_order_relaxed) & bit)
+				continue;
+
+			// stop at the first parent found in the frontier
+			for (int e = inOffsets[v]; e < inOffsets[v + 1]; e++) {
+				int u = inSources[e];
+				if (this->FrontierBits[u >> 6] & (1ull << (u & 63))) {
+					this->Visited[v >> 6].fetch_or(bit, memory_order_relaxed);
+					local[t].push_back(v);
+					break;
+				}
+			}
+		}
+	});
+
+	// ranges are ascending, so concatenation keeps Next sorted
+	for (vector<int>& l : local)
+		this->Next.insert(this->Next.end(), l.begin(), l.end());
+}
+
+
+//
+// Run:
+//
+// Searches from vertex # start and returns the reached vertices, level
+// by level.  Empty if start does not exist or the graph is not frozen.
+//
+const vector<int>& BFSEngine::Run(int start, int numThreads)
+{
+	this->Order.clear();
+	this->Depth.assign(this->NumVertices, -1);
+	this->NumTopDownSteps = 0;
+	this->NumBottomUpSteps = 0;
+
+	if (!this->G.IsFrozen() || start < 0 || start >= this->NumVertices)
+		return this->Order;
+
+	const vector<int>& offsets = this->G.GetOffsets();
+	auto degree = [&](int v) { return (long long)(offsets[v + 1] - offsets[v]); };
+
+	for (int w = 0; w < this->NumWords; w++)
+		this->Visited[w].store(0, memory_order_relaxed);
+
+	this->Frontier.assign(1, start);
+	this->Visited[start >> 6].fetch_or(1ull << (start & 63), memory_order_relaxed);
+	this->Depth[start] = 0;
+	this->Order.push_back(start);
+
+	long long unexplored = (long long)this->G.GetNumEdges() - degree(start);
+	bool      bottomUp = false;
+
+	for (int level = 1; !this->Frontier.empty(); level++) {
+		long long frontierEdges = 0;
+		for (int u : this->Frontier)
+			frontierEdges += degree(u);
+
+		// pick the direction for this level
+		if (bottomUp && (long long)this->Frontier.size() * Beta < this->NumVertices)
+			bottomUp = false;
+		else if (!bottomUp && frontierEdges * Alpha > unexplored)
+			bottomUp = true;
+
+		this->Next.clear();
+		if (bottomUp) {
+			this->BottomUp(numThreads);
+			this->NumBottomUpSteps++;
+		}
+		else {
+			this->TopDown(numThreads);
+			this->NumTopDownSteps++;
+		}
+
+		for (int v : this->Next) {
+			this->Depth[v] = level;
+			unexplored -= degree(v);
+		}
+
+		this->Order.insert(this->Order.end(), this->Next.begin(), this->Next.end());
+		this->Frontier.swap(this->Next);
+	}
+
+	return this->Order;
+}
+
+
+//
+// returns the level of v in the last run, -1 if v was not reached
+//
+int BFSEngine::GetDepth(int v)
+{
+	if (v < 0 || v >= (int)this->Depth.size())
+		return -1;
+
+	return this->Depth[v];
+}
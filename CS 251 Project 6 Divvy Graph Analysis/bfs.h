@@ -0,0 +1,65 @@
+//
+// bfs.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+#include "graph.h"
+
+using namespace std;
+
+
+//
+// BFSEngine class
+//
+// Level-synchronous, direction-optimizing BFS over a frozen graph.
+// Each level is expanded top-down (frontier -> out-edges) while the
+// frontier is small, and bottom-up (unvisited vertices -> in-edges)
+// once the frontier's edges outweigh the unvisited part of the graph
+// (Beamer et al.).  Both directions can be split across threads.
+//
+// The result lists the reached vertices level by level, ascending by
+// vertex # within a level; for the exact visit order of a queue-based
+// BFS use Graph::BFS(int).  Buffers are reused across runs.
+//
+class BFSEngine
+{
+private:
+	Graph        &G;				// graph being searched, must be frozen
+	int           NumVertices;		// # of vertices
+
+	int           NumWords;			// # of 64-bit words per bitmap
+	unique_ptr<atomic<uint64_t>[]> Visited;	// visited bitmap
+	vector<uint64_t> FrontierBits;	// frontier bitmap, bottom-up steps
+	vector<int>   Frontier;			// current level
+	vector<int>   Next;				// next level
+	vector<int>   Order;			// result of the last run
+	vector<int>   Depth;			// level of each vertex, -1 if not reached
+
+	// private function prototypes
+	long long TopDown(int numThreads);
+	void BottomUp(int numThreads);
+
+public:
+	int           NumTopDownSteps;	// direction choices of the last run,
+	int           NumBottomUpSteps;	// for benchmarking
+
+	BFSEngine(Graph& G);
+
+	// public function prototypes
+	const vector<int>& Run(int start, int numThreads);
+	int GetDepth(int v);
+};
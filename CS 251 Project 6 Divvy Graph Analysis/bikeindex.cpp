@@ -0,0 +1,263 @@
+//
+// bikeindex.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#include <algorithm>
+#include <thread>
+
+#include "bikeindex.h"
+
+using namespace std;
+
+
+//
+// sorts the items on numThreads threads: each thread sorts a run,
+// then neighboring runs are merged pairwise, halving the # of runs
+// each round
+//
+static void ParallelSort(vector<pair<uint64_t, uint64_t>>& items, int numThreads)
+{
+	auto           begin = items.begin();
+	vector<size_t> bounds(numThreads + 1);
+
+	for (int t = 0; t <= numThreads; t++)
+		bounds[t] = items.size() * t / numThreads;
+
+	vector<thread> workers;
+	for (int t = 0; t < numThreads; t++)
+		workers.push_back(thread([=]() { sort(begin + bounds[t], begin + bounds[t + 1]); }));
+	for (thread& w : workers)
+		w.join();
+
+	for (int width = 1; width < numThreads; width *= 2) {
+		workers.clear();
+
+		for (int t = 0; t + width < numThreads; t += 2 * width) {
+			auto first = begin + bounds[t];
+			auto middle = begin + bounds[t + width];
+			auto last = begin + bounds[min(t + 2 * width, numThreads)];
+
+			workers.push_back(thread([=]() { inplace_merge(first, middle, last); }));
+		}
+		for (thread& w : workers)
+			w.join();
+	}
+}
+
+
+//
+// Build:
+//
+// Groups the trips by bike and orders each bike's trips by start time,
+// then trip id (timestamps may only have minutes, trip ids grow with
+// the start time).  The columns are those of the trip store; ids and
+// start times are never negative.
+//
+void BikeIndex::Build(const vector<int32_t>& bikeIDs, const vector<int32_t>& startTimes,
+	const vector<int32_t>& tripIDs, int numThreads)
+{
+	int numTrips = (int)bikeIDs.size();
+	numThreads = max(1, min(numThreads, numTrips / 65536 + 1));
+
+	// (bike, start time) and (trip id, row) keys of every trip
+	vector<pair<uint64_t, uint64_t>> items(numTrips);
+	for (int i = 0; i < numTrips; i++) {
+		items[i] = make_pair(((uint64_t)(uint32_t)bikeIDs[i] << 32) | (uint32_t)startTimes[i],
+			((uint64_t)(uint32_t)tripIDs[i] << 32) | (uint32_t)i);
+	}
+
+	ParallelSort(items, numThreads);
+
+	// rows in order, and where each bike starts
+	this->Rows.resize(numTrips);
+	this->Bikes.clear();
+	this->BikeStart.clear();
+
+	for (int i = 0; i < numTrips; i++) {
+		int row = (int)(uint32_t)items[i].second;
+
+		if (i == 0 || bikeIDs[row] != this->Bikes.back()) {
+			this->Bikes.push_back(bikeIDs[row]);
+			this->BikeStart.push_back(i);
+		}
+		this->Rows[i] = row;
+	}
+	this->BikeStart.push_back(numTrips);
+}
+
+
+//
+// DetectMoves:
+//
+// Walks every bike's trajectory and counts a move from the station
+// where a trip ended to the station where the bike's next trip
+// started, whenever the two differ.  Stations are as in the from / to
+// columns (vertex #'s).  The bikes are split over numThreads threads.
+// Returns the total # of moves.
+//
+long long BikeIndex::DetectMoves(const vector<int32_t>& from, const vector<int32_t>& to, TripCounter& moves,
+	int numThreads)
+{
+	int numBikes = this->GetNumBikes();
+	numThreads = max(1, min(numThreads, numBikes / 256 + 1));
+
+	vector<TripCounter> counters(numThreads);
+	vector<long long>   totals(numThreads, 0);
+	vector<thread>      workers;
+
+	for (int t = 0; t < numThreads; t++) {
+		workers.push_back(thread([&, t]() {
+			int first = (int)((long long)numBikes * t / numThreads);
+			int last = (int)((long long)numBikes * (t + 1) / numThreads);
+
+			for (int b = first; b < last; b++) {
+				for (int i = this->BikeStart[b] + 1; i < this->BikeStart[b + 1]; i++) {
+					int endedAt = to[this->Rows[i - 1]];
+					int startedAt = from[this->Rows[i]];
+
+					if (endedAt != startedAt) {
+						counters[t].Add(endedAt, startedAt, 1);
+						totals[t]++;
+					}
+				}
+			}
+		}));
+	}
+	for (thread& w : workers)
+		w.join();
+
+	long long total = 0;
+	for (int t = 0; t < numThreads; t++) {
+		moves.Merge(counters[t]);
+		total += totals[t];
+	}
+
+	return total;
+}
+
+
+// # of distinct bikes
+int BikeIndex::GetNumBikes()
+{
+	return (int)this->Bikes.size();
+}
+
+
+//
+// returns the position of the bike with the given id, its trips are
+// Rows[BikeStart[pos] .. BikeStart[pos+1]); -1 if there is none
+//
+int BikeIndex::FindBike(int bikeID)
+{
+	auto it = lower_bound(this->Bikes.begin(), this->Bikes.end(), bikeID);
+
+	if (it == this->Bikes.end() || *it != bikeID)
+		return -1;
+
+	return (int)(it - this->Bikes.begin());
+}
+
+
+// getter for the trip rows, by bike and start time
+const vector<int>& BikeIndex::GetRows()
+{
+	return this->Rows;
+}
+
+
+// getter for where each bike's trips start in the rows
+const vector<int>& BikeIndex::GetBikeStart()
+{
+	return this->BikeStart;
+}
+
+
+//
+// Build:
+//
+// Lays out the moves: move i goes from srcs[i] to dests[i] with
+// counts[i] moves.  Replaces any earlier moves; pairs with a vertex
+// outside [0, numVertices) are dropped.
+//
+void MoveEdges::Build(const vector<int>& srcs, const vector<int>& dests, const vector<int>& counts, int numVertices)
+{
+	int n = numVertices;
+
+	// move edges by source, then destination
+	vector<int> order;
+	for (int i = 0; i < (int)srcs.size(); i++) {
+		if (srcs[i] >= 0 && srcs[i] < n && dests[i] >= 0 && dests[i] < n)
+			order.push_back(i);
+	}
+	sort(order.begin(), order.end(), [&](int i, int j) {
+		return (srcs[i] != srcs[j]) ? srcs[i] < srcs[j] : dests[i] < dests[j];
+	});
+
+	int m = (int)order.size();
+	this->Offsets.assign(n + 1, 0);
+	this->Dests.resize(m);
+	this->Weights.resize(m);
+	this->InOffsets.assign(n + 1, 0);
+	this->InSources.resize(m);
+	this->InWeights.resize(m);
+
+	for (int k = 0; k < m; k++) {
+		this->Offsets[srcs[order[k]] + 1]++;
+		this->InOffsets[dests[order[k]] + 1]++;
+		this->Dests[k] = dests[order[k]];
+		this->Weights[k] = counts[order[k]];
+	}
+	for (int v = 0; v < n; v++) {
+		this->Offsets[v + 1] += this->Offsets[v];
+		this->InOffsets[v + 1] += this->InOffsets[v];
+	}
+
+	// reverse, visiting the sources in order keeps them sorted
+	vector<int> fill(this->InOffsets.begin(), this->InOffsets.end() - 1);
+	for (int k = 0; k < m; k++) {
+		int at = fill[dests[order[k]]]++;
+
+		this->InSources[at] = srcs[order[k]];
+		this->InWeights[at] = counts[order[k]];
+	}
+}
+
+
+// getters for the move edges, see Build()
+const vector<int>& MoveEdges::GetOffsets()
+{
+	return this->Offsets;
+}
+
+const vector<int>& MoveEdges::GetDests()
+{
+	return this->Dests;
+}
+
+const vector<int>& MoveEdges::GetWeights()
+{
+	return this->Weights;
+}
+
+const vector<int>& MoveEdges::GetInOffsets()
+{
+	return this->InOffsets;
+}
+
+const vector<int>& MoveEdges::GetInSources()
+{
+	return this->InSources;
+}
+
+const vector<int>& MoveEdges::GetInWeights()
+{
+	return this->InWeights;
+}
@@ -0,0 +1,86 @@
+//
+// bikeindex.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "tripcounter.h"
+
+using namespace std;
+
+
+//
+// BikeIndex class
+//
+// The trajectory of every bike: the trips (rows of the trip store)
+// grouped by bike and ordered by start time.  The trips of the i-th
+// bike, by ascending bike id, are Rows[BikeStart[i] .. BikeStart[i+1]).
+//
+// A bike whose next trip starts at another station than where its
+// previous trip ended was moved in between, by a rebalancing truck;
+// DetectMoves() counts these moves per (from, to) station.
+//
+class BikeIndex
+{
+private:
+	vector<int>     Rows;			// trip rows, by bike and start time
+	vector<int>     BikeStart;		// per bike, NumBikes+1 entries
+	vector<int32_t> Bikes;			// bike ids, ascending
+
+public:
+
+	// public function prototypes
+	void Build(const vector<int32_t>& bikeIDs, const vector<int32_t>& startTimes, const vector<int32_t>& tripIDs,
+		int numThreads);
+	long long DetectMoves(const vector<int32_t>& from, const vector<int32_t>& to, TripCounter& moves,
+		int numThreads);
+	int GetNumBikes();
+	int FindBike(int bikeID);
+	const vector<int>& GetRows();
+	const vector<int>& GetBikeStart();
+};
+
+
+//
+// MoveEdges class
+//
+// The rebalancing moves, a second edge type over the graph's vertices:
+// move edge k goes from a source vertex to a destination vertex with
+// Weights[k] moves, at most one per (source, destination) pair.  Laid
+// out like the frozen trips, forward and reverse, with the destinations
+// (sources) sorted per vertex.  Kept with the trips they come from, not
+// in the graph, since they are only known once the trip store loads and
+// the graph is shared read-only by then.
+//
+class MoveEdges
+{
+private:
+	vector<int> Offsets;			// moves out of v are [Offsets[v], Offsets[v+1])
+	vector<int> Dests;				// destination of each move edge, sorted per vertex
+	vector<int> Weights;			// # of moves along each move edge
+	vector<int> InOffsets;			// moves into v are [InOffsets[v], InOffsets[v+1]),
+	vector<int> InSources;			// by source,
+	vector<int> InWeights;			// with the # of moves
+
+public:
+
+	// public function prototypes
+	void Build(const vector<int>& srcs, const vector<int>& dests, const vector<int>& counts, int numVertices);
+	const vector<int>& GetOffsets();
+	const vector<int>& GetDests();
+	const vector<int>& GetWeights();
+	const vector<int>& GetInOffsets();
+	const vector<int>& GetInSources();
+	const vector<int>& GetInWeights();
+};
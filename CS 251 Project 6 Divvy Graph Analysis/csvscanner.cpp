@@ -0,0 +1,359 @@
+//
+// csvscanner.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "csvscanner.h"
+
+using namespace std;
+
+
+//
+// Constructor:
+//
+MappedFile::MappedFile()
+{
+	this->Bytes = nullptr;
+	this->Length = 0;
+#ifdef _WIN32
+	this->FileHandle = INVALID_HANDLE_VALUE;
+	this->MapHandle = NULL;
+#endif
+}
+
+
+//
+// Destructor:
+//
+MappedFile::~MappedFile()
+{
+	this->Close();
+}
+
+
+//
+// maps the whole file into memory, returns false if the file cannot
+// be opened; an empty file opens fine with Size() == 0
+//
+bool MappedFile::Open(const string& filename)
+{
+	this->Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		CloseHandle(file);
+		return false;
+	}
+
+	this->FileHandle = file;
+	this->Length = (size_t)size.QuadPart;
+
+	// nothing to map
+	if (this->Length == 0)
+		return true;
+
+	HANDLE map = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (map == NULL) {
+		this->Close();
+		return false;
+	}
+
+	this->MapHandle = map;
+	this->Bytes = (const char *)MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+	if (this->Bytes == nullptr) {
+		this->Close();
+		return false;
+	}
+#else
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		return false;
+	}
+
+	this->Length = (size_t)st.st_size;
+
+	// nothing to map
+	if (this->Length == 0) {
+		close(fd);
+		return true;
+	}
+
+	void *p = mmap(nullptr, this->Length, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);					// the mapping keeps its own reference
+
+	if (p == MAP_FAILED) {
+		this->Length = 0;
+		return false;
+	}
+
+	madvise(p, this->Length, MADV_SEQUENTIAL);
+	this->Bytes = (const char *)p;
+#endif
+
+	return true;
+}
+
+
+//
+// releases the mapping
+//
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (this->Bytes != nullptr)
+		UnmapViewOfFile(this->Bytes);
+	if (this->MapHandle != NULL)
+		CloseHandle(this->MapHandle);
+	if (this->FileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle(this->FileHandle);
+
+	this->MapHandle = NULL;
+	this->FileHandle = INVALID_HANDLE_VALUE;
+#else
+	if (this->Bytes != nullptr)
+		munmap((void *)this->Bytes, this->Length);
+#endif
+
+	this->Bytes = nullptr;
+	this->Length = 0;
+}
+
+
+// getter for the mapped bytes
+const char *MappedFile::Data()
+{
+	return this->Bytes;
+}
+
+
+// getter for the # of mapped bytes
+size_t MappedFile::Size()
+{
+	return this->Length;
+}
+
+
+//
+// Constructor:
+//
+CsvScanner::CsvScanner(const char *data, size_t size)
+{
+	this->Cur = data;
+	this->End = data + size;
+}
+
+
+//
+// hands back the next line without its line terminator ("\n" or
+// "\r\n"), returns false once the buffer is exhausted.  A last line
+// without a terminator is still returned.
+//
+bool CsvScanner::NextLine(string_view& line)
+{
+	if (this->Cur == nullptr || this->Cur >= this->End)
+		return false;
+
+	const char *start = this->Cur;
+	const char *nl = (const char *)memchr(start, '\n', this->End - start);
+	const char *stop = (nl != nullptr) ? nl : this->End;
+
+	this->Cur = (nl != nullptr) ? nl + 1 : this->End;
+
+	if (stop > start && stop[-1] == '\r')
+		stop--;
+
+	line = string_view(start, stop - start);
+	return true;
+}
+
+
+//
+// returns the # of bytes consumed so far, measured from base
+//
+size_t CsvScanner::Offset(const char *base)
+{
+	return this->Cur - base;
+}
+
+
+//
+// splits [begin, end), which starts at the beginning of a line, into
+// numChunks line-aligned chunks of about the same size: chunk t is
+// [bounds[t], bounds[t+1]).  Chunks may be empty.
+//
+vector<const char *> CsvScanner::SplitChunks(const char *begin, const char *end, int numChunks)
+{
+	vector<const char *> bounds(numChunks + 1, end);
+
+	// each boundary moved forward to the start of a line
+	bounds[0] = begin;
+	for (int t = 1; t < numChunks; t++) {
+		const char *p = begin + (end - begin) * t / numChunks;
+		if (p < bounds[t - 1])
+			p = bounds[t - 1];
+		while (p < end && p[-1] != '\n')
+			p++;
+		bounds[t] = p;
+	}
+
+	return bounds;
+}
+
+
+//
+// splits the line into at most maxFields fields, returns the # of
+// fields stored; the last field keeps any remaining commas
+//
+int CsvScanner::Split(string_view line, string_view *fields, int maxFields)
+{
+	int n = 0;
+
+	while (n < maxFields - 1) {
+		size_t comma = line.find(',');
+		if (comma == string_view::npos)
+			break;
+
+		fields[n++] = line.substr(0, comma);
+		line.remove_prefix(comma + 1);
+	}
+
+	if (n < maxFields)
+		fields[n++] = line;
+
+	return n;
+}
+
+
+//
+// jumps straight to column col (0-based) of the line, returns false if
+// the line has fewer columns
+//
+bool CsvScanner::Field(string_view line, int col, string_view& field)
+{
+	const char *p = line.data();
+	const char *end = p + line.size();
+
+	// skip col commas
+	for (int c = 0; c < col; c++) {
+		p = (const char *)memchr(p, ',', end - p);
+		if (p == nullptr)
+			return false;
+		p++;
+	}
+
+	const char *stop = (const char *)memchr(p, ',', end - p);
+	if (stop == nullptr)
+		stop = end;
+
+	field = string_view(p, stop - p);
+	return true;
+}
+
+
+//
+// fast path for two columns in one pass over the line, col1 < col2
+//
+bool CsvScanner::Fields(string_view line, int col1, string_view& field1, int col2, string_view& field2)
+{
+	if (!Field(line, col1, field1))
+		return false;
+
+	// continue from the end of the first field
+	size_t used = (field1.data() + field1.size()) - line.data();
+	if (used >= line.size())
+		return false;
+
+	return Field(line.substr(used + 1), col2 - col1 - 1, field2);
+}
+
+
+//
+// parses a (possibly signed) decimal integer in place, returns false
+// if the field is empty, not a number, or out of the range of an int
+// (as stoi does)
+//
+bool CsvScanner::ParseInt(string_view field, int& value)
+{
+	const size_t MaxDigits = 10;	// INT_MAX has 10
+
+	size_t i = 0;
+	bool   negative = false;
+
+	if (i < field.size() && (field[i] == '-' || field[i] == '+')) {
+		negative = (field[i] == '-');
+		i++;
+	}
+
+	if (i == field.size() || field.size() - i > MaxDigits)
+		return false;
+
+	// summed up negated, INT_MIN has no positive counterpart
+	int result = 0;
+	for (; i < field.size(); i++) {
+		char c = field[i];
+		if (c < '0' || c > '9')
+			return false;
+
+		int digit = c - '0';
+		if (result < (INT_MIN + digit) / 10)
+			return false;
+		result = result * 10 - digit;
+	}
+
+	if (!negative && result == INT_MIN)
+		return false;
+
+	value = negative ? result : -result;
+	return true;
+}
+
+
+//
+// parses a floating point field, returns false if it is not a number
+//
+bool CsvScanner::ParseDouble(string_view field, double& value)
+{
+	char buf[64];
+
+	// strtod needs a terminated string, fields are short
+	if (field.empty() || field.size() >= sizeof(buf))
+		return false;
+
+	memcpy(buf, field.data(), field.size());
+	buf[field.size()] = '\0';
+
+	char *stop;
+	value = strtod(buf, &stop);
+	return stop == buf + field.size();
+}
@@ -0,0 +1,80 @@
+//
+// csvscanner.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+
+//
+// MappedFile class
+//
+// Read-only memory mapping of a whole file.  The mapping is released
+// by Close() or the destructor.
+//
+class MappedFile
+{
+private:
+	const char *Bytes;				// first byte of the mapping
+	size_t      Length;				// # of bytes mapped
+#ifdef _WIN32
+	void       *FileHandle;			// file handle
+	void       *MapHandle;			// file mapping handle
+#endif
+
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// public function prototypes
+	bool Open(const string& filename);
+	void Close();
+	const char *Data();
+	size_t Size();
+};
+
+
+//
+// CsvScanner class
+//
+// Walks a buffer of comma-separated lines without copying: lines and
+// fields are handed back as string_views into the buffer.  Quoted
+// fields are not supported, the Divvy files never use them.
+//
+class CsvScanner
+{
+private:
+	const char *Cur;				// start of the next line
+	const char *End;				// one past the last byte
+
+public:
+	CsvScanner(const char *data, size_t size);
+
+	// public function prototypes
+	bool NextLine(string_view& line);
+	size_t Offset(const char *base);
+
+	static vector<const char *> SplitChunks(const char *begin, const char *end, int numChunks);
+	static int Split(string_view line, string_view *fields, int maxFields);
+	static bool Field(string_view line, int col, string_view& field);
+	static bool Fields(string_view line, int col1, string_view& field1, int col2, string_view& field2);
+	static bool ParseInt(string_view field, int& value);
+	static bool ParseDouble(string_view field, double& value);
+};
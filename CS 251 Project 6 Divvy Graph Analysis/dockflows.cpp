@@ -0,0 +1,147 @@
+//
+// dockflows.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#include <algorithm>
+
+#include "dockflows.h"
+#include "stats.h"
+
+using namespace std;
+
+
+//
+// the departure and arrival cells (vertex * 24 + hour) and the day of
+// size trips: no branches, so the compiler vectorizes it
+//
+static inline void FlowCells(const int32_t *from, const int32_t *to, const int32_t *startTimes,
+	const int32_t *durations, const uint8_t *startBuckets, int size, uint32_t maxDay,
+	uint32_t *leave, uint32_t *arrive, uint32_t *day)
+{
+	for (int i = 0; i < size; i++) {
+		uint32_t start = (uint32_t)startTimes[i];
+		uint32_t end = start + (uint32_t)max(durations[i], 0);
+
+		leave[i] = (uint32_t)from[i] * 24 + startBuckets[i] % 24;
+		arrive[i] = (uint32_t)to[i] * 24 + end / 3600 % 24;
+		day[i] = min(start / 86400, maxDay);
+	}
+}
+
+
+//
+// default constructor: no trips counted
+//
+DockFlows::DockFlows()
+	: NumVertices(0), NumDays(0)
+{ }
+
+
+//
+// counts the trips (the trip store's columns) per station and hour in
+// a single pass.  The pass goes a block of trips at a time: first the
+// departure and arrival cells and the day of every trip in the block
+// (FlowCells()), then the counts, the one part that has to go trip by
+// trip.
+//
+void DockFlows::Build(const vector<int32_t>& from, const vector<int32_t>& to, const vector<int32_t>& startTimes,
+	const vector<int32_t>& durations, const vector<uint8_t>& startBuckets, int numVertices)
+{
+	STAT_TIMER(timer, Stat::DockFlows);
+
+	const int BlockSize = 1024;				// trips per block
+	const int MaxDays = 68 * 366;			// starttimes are in 2000-2067
+
+	this->NumVertices = numVertices;
+	this->Departures.assign((size_t)numVertices * 24, 0);
+	this->Arrivals.assign((size_t)numVertices * 24, 0);
+
+	vector<uint8_t> daySeen(MaxDays, 0);
+	uint32_t        leave[BlockSize], arrive[BlockSize], day[BlockSize];
+	size_t          n = startTimes.size();
+
+	for (size_t begin = 0; begin < n; begin += BlockSize) {
+		int size = (int)min((size_t)BlockSize, n - begin);
+
+		// a whole block's constant trip count lets it vectorize even
+		// under -O2's cheapest cost model
+		if (size == BlockSize)
+			FlowCells(&from[begin], &to[begin], &startTimes[begin], &durations[begin], &startBuckets[begin],
+				BlockSize, MaxDays - 1, leave, arrive, day);
+		else
+			FlowCells(&from[begin], &to[begin], &startTimes[begin], &durations[begin], &startBuckets[begin],
+				size, MaxDays - 1, leave, arrive, day);
+
+		for (int i = 0; i < size; i++) {
+			this->Departures[leave[i]]++;
+			this->Arrivals[arrive[i]]++;
+			daySeen[day[i]] = 1;
+		}
+	}
+
+	this->NumDays = (int)count(daySeen.begin(), daySeen.end(), 1);
+
+	STAT_ITEMS(timer, n);
+}
+
+
+//
+// # of days with trips, the days an average day is taken over
+//
+int DockFlows::GetNumDays()
+{
+	return this->NumDays;
+}
+
+
+//
+// bikes arriving minus bikes leaving vertex v in the hour, per day
+//
+double DockFlows::NetFlow(int v, int hour)
+{
+	if (v < 0 || v >= this->NumVertices || this->NumDays == 0)
+		return 0;
+
+	size_t cell = (size_t)v * 24 + hour;
+	return (double)(this->Arrivals[cell] - this->Departures[cell]) / this->NumDays;
+}
+
+
+//
+// plays out an average day of vertex v's docks from midnight to the end
+// of the hour, starting half full.  Each hour adds its net flow; bikes
+// that would leave an empty station or arrive at a full one cannot, and
+// are counted as short instead
+//
+DockFlows::Projection DockFlows::Project(int v, int capacity, int hour)
+{
+	Projection p;
+	p.Occupancy = capacity / 2.0;
+
+	for (int h = 0; h <= hour; h++) {
+		p.Occupancy += this->NetFlow(v, h);
+
+		if (p.Occupancy < 0) {
+			p.BikesShort -= p.Occupancy;
+			p.Occupancy = 0;
+			if (p.EmptyAt == -1)
+				p.EmptyAt = h;
+		}
+		else if (p.Occupancy > capacity) {
+			p.DocksShort += p.Occupancy - capacity;
+			p.Occupancy = capacity;
+			if (p.FullAt == -1)
+				p.FullAt = h;
+		}
+	}
+
+	return p;
+}
@@ -0,0 +1,64 @@
+//
+// dockflows.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+
+
+//
+// DockFlows class
+//
+// The trips leaving and arriving at each station by hour of the day,
+// counted over the trip store: a trip leaves in the hour of its
+// starttime and arrives in the hour of starttime + tripduration.  From
+// them Project() plays out an average day of a station's docks,
+// starting half full at midnight, to see where bikes or docks run out.
+//
+class DockFlows
+{
+public:
+
+	//
+	// Projection class
+	//
+	// A station's average day up to the end of an hour, see Project().
+	//
+	class Projection
+	{
+	public:
+		double Occupancy = 0;		// bikes docked at the end of the hour
+		int    EmptyAt = -1;		// first hour it ran out of bikes, -1 if it did not
+		int    FullAt = -1;			// first hour it ran out of docks, -1 if it did not
+		double BikesShort = 0;		// departures with no bike left, per day
+		double DocksShort = 0;		// arrivals with no dock left, per day
+	};
+
+private:
+	int             NumVertices;	// # of stations counted
+	int             NumDays;		// # of days with trips
+	vector<int32_t> Departures;		// per vertex, 24 hours each
+	vector<int32_t> Arrivals;		// likewise
+
+public:
+	DockFlows();
+
+	// public function prototypes
+	void Build(const vector<int32_t>& from, const vector<int32_t>& to, const vector<int32_t>& startTimes,
+		const vector<int32_t>& durations, const vector<uint8_t>& startBuckets, int numVertices);
+	int GetNumDays();
+	double NetFlow(int v, int hour);
+	Projection Project(int v, int capacity, int hour);
+};
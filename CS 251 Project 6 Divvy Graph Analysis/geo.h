@@ -0,0 +1,35 @@
+//
+// geo.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cmath>
+
+
+const double EarthRadiusMeters = 6371008.8;		// mean Earth radius
+const double DegreesToRadians = 3.14159265358979323846 / 180.0;
+
+
+//
+// great-circle (haversine) distance in meters between two points
+// given in degrees
+//
+inline double Haversine(double lat1, double lon1, double lat2, double lon2)
+{
+	double dLat = (lat2 - lat1) * DegreesToRadians;
+	double dLon = (lon2 - lon1) * DegreesToRadians;
+
+	double a = sin(dLat / 2) * sin(dLat / 2)
+		+ cos(lat1 * DegreesToRadians) * cos(lat2 * DegreesToRadians) * sin(dLon / 2) * sin(dLon / 2);
+
+	return 2 * EarthRadiusMeters * asin(sqrt(a < 1 ? a : 1));
+}
@@ -11,8 +11,10 @@
 
 
 #include <iostream>
+#include <algorithm>
 
 #include "graph.h"
+#include "stats.h"
 
 using namespace std;
 
@@ -20,63 +22,177 @@ using namespace std;
 //
 // Constructor:
 //
-Graph::Graph(int N)
+template <typename V, typename W>
+BasicGraph<V, W>::BasicGraph(int N)
 {
+	// no more vertices than V can number
+	N = (int)min<long long>(N, (long long)numeric_limits<V>::max() + 1);
+
 	this->NumVertices = 0;
 	this->NumEdges = 0;
 	this->Capacity = N;
 
-	this->Vertices = new Edge*[N];
-	this->Names = new string[N];
+	this->Vertices = new uint32_t[N];
+	this->Names.Reserve(N);
+	this->OutDegree.assign(N, 0);
+	this->OutTrips.assign(N, 0);
+	this->InDegree.assign(N, 0);
+	this->InTrips.assign(N, 0);
+	this->Frozen = false;
 }
 
 
 //
 // Destructor:
 //
-Graph::~Graph()
+// Frees the vertex array; the edges go with the arena, the names with
+// the pool.
+//
+template <typename V, typename W>
+BasicGraph<V, W>::~BasicGraph()
 {
-	//
-	// Future work:
-	//
+	delete[] this->Vertices;
+}
+
+
+//
+// Move constructor:
+//
+// Takes over other's arrays and edges, leaving other an empty graph
+// of capacity 0.
+//
+template <typename V, typename W>
+BasicGraph<V, W>::BasicGraph(BasicGraph&& other) noexcept
+	: Edges(move(other.Edges)),
+	Names(move(other.Names)),
+	OutDegree(move(other.OutDegree)),
+	OutTrips(move(other.OutTrips)),
+	InDegree(move(other.InDegree)),
+	InTrips(move(other.InTrips)),
+	Offsets(move(other.Offsets)),
+	Dests(move(other.Dests)),
+	Weights(move(other.Weights)),
+	NameOrder(move(other.NameOrder)),
+	InOffsets(move(other.InOffsets)),
+	InSources(move(other.InSources)),
+	InEdges(move(other.InEdges)),
+	SCCs(move(other.SCCs)),
+	SCCSizes(move(other.SCCSizes)),
+	WCCs(move(other.WCCs)),
+	WCCSizes(move(other.WCCSizes))
+{
+	this->Vertices = other.Vertices;
+	this->NumVertices = other.NumVertices;
+	this->NumEdges = other.NumEdges;
+	this->Capacity = other.Capacity;
+	this->Frozen = other.Frozen;
+
+	other.Vertices = nullptr;
+	other.NumVertices = 0;
+	other.NumEdges = 0;
+	other.Capacity = 0;
+	other.Frozen = false;
+}
+
+
+//
+// Move assignment:
+//
+template <typename V, typename W>
+BasicGraph<V, W>& BasicGraph<V, W>::operator=(BasicGraph&& other) noexcept
+{
+	if (this != &other) {
+		delete[] this->Vertices;
+
+		this->Edges = move(other.Edges);
+		this->Names = move(other.Names);
+		this->OutDegree = move(other.OutDegree);
+		this->OutTrips = move(other.OutTrips);
+		this->InDegree = move(other.InDegree);
+		this->InTrips = move(other.InTrips);
+		this->Offsets = move(other.Offsets);
+		this->Dests = move(other.Dests);
+		this->Weights = move(other.Weights);
+		this->NameOrder = move(other.NameOrder);
+		this->InOffsets = move(other.InOffsets);
+		this->InSources = move(other.InSources);
+		this->InEdges = move(other.InEdges);
+		this->SCCs = move(other.SCCs);
+		this->SCCSizes = move(other.SCCSizes);
+		this->WCCs = move(other.WCCs);
+		this->WCCSizes = move(other.WCCSizes);
+		this->Vertices = other.Vertices;
+		this->NumVertices = other.NumVertices;
+		this->NumEdges = other.NumEdges;
+		this->Capacity = other.Capacity;
+		this->Frozen = other.Frozen;
+
+		other.Vertices = nullptr;
+		other.NumVertices = 0;
+		other.NumEdges = 0;
+		other.Capacity = 0;
+		other.Frozen = false;
+	}
+
+	return *this;
 }
 
 
 // getter for number of vertices
-int Graph::GetNumVertices() 
+template <typename V, typename W>
+int BasicGraph<V, W>::GetNumVertices() 
 {
 	return this->NumVertices;
 }
 
 
 // getter for number of edges
-int Graph::GetNumEdges() 
+template <typename V, typename W>
+int BasicGraph<V, W>::GetNumEdges() 
 {
 	return this->NumEdges;
 }
 
 
+// getter for max capacity of the graph
+template <typename V, typename W>
+int BasicGraph<V, W>::GetCapacity() 
+{
+	return this->Capacity;
+}
+
+
 //
 // returns true if edge exists, false otherwise is returned
 //
-bool Graph::EdgeExist(string src, string dest) 
+template <typename V, typename W>
+bool BasicGraph<V, W>::EdgeExist(string_view src, string_view dest) 
 {
 	// get index of source and destination
-	int srcID = this->FindVertexByName(src);
-	int destID = this->FindVertexByName(dest);
+	return this->EdgeExist(this->FindVertexByName(src), this->FindVertexByName(dest));
+}
 
+
+//
+// same, by vertex #
+//
+template <typename V, typename W>
+bool BasicGraph<V, W>::EdgeExist(int srcID, int destID)
+{
 	// source does not exist, return false
-	if (srcID == -1) {
+	if (srcID < 0 || srcID >= this->NumVertices) {
 		return false;
 	}
 
+	// frozen: binary search the source's edges
+	if (this->Frozen)
+		return this->FindEdge(srcID, destID) != -1;
+
 	// traverse neighbors and check if destination is adjacent to source
-	Edge *cur = this->Vertices[srcID];
-	while (cur != NULL) {
-		if (cur->Dest == destID) {
+	for (Neighbor n : this->Neighbors(srcID)) {
+		if (n.Dest == destID) {
 			return true;	// found	
 		}
-		cur = cur->Next;	// go to the next node
 	}
 
 	return false;			// not found
@@ -86,24 +202,34 @@ bool Graph::EdgeExist(string src, string dest)
 //
 // updates the given edge by given weight
 //
-void Graph::UpdateWeight(string src, string dest, int weight) 
+template <typename V, typename W>
+void BasicGraph<V, W>::UpdateWeight(string_view src, string_view dest, int weight) 
 {
-	
-	int srcID = FindVertexByName(src);
-	int destID = FindVertexByName(dest);
+	this->UpdateWeight(FindVertexByName(src), FindVertexByName(dest), weight);
+}
+
 
-	// source or destination ID does not exist
-	if (srcID == -1 || destID == -1)
+//
+// same, by vertex #
+//
+template <typename V, typename W>
+void BasicGraph<V, W>::UpdateWeight(int srcID, int destID, int weight)
+{
+	// source or destination ID does not exist, or graph is frozen
+	if (srcID < 0 || srcID >= this->NumVertices || destID < 0 || destID >= this->NumVertices || this->Frozen)
 		return;
 
 	// find the edge to be updated
-	Edge *cur = this->Vertices[srcID];
-	while (cur != NULL) {
-		if (cur->Dest == destID) {	// found
-			cur->Weight += weight;	// update
+	uint32_t cur = this->Vertices[srcID];
+	while (cur != NoEdge) {
+		Edge& e = this->Edges[cur];
+		if ((int)e.Dest == destID) {	// found
+			e.Weight += weight;		// update
+			this->OutTrips[srcID] += weight;
+			this->InTrips[destID] += weight;
 			return;
 		}
-		cur = cur->Next;			// go to the next node
+		cur = e.Next;				// go to the next node
 	}
 }
 
@@ -116,28 +242,27 @@ void Graph::UpdateWeight(string src, string dest, int weight)
 // graph is full, or (2) the vertex already exists in the
 // graph.
 //
-bool Graph::AddVertex(string v)
+template <typename V, typename W>
+bool BasicGraph<V, W>::AddVertex(string_view v)
 {
 	// if the graph is "full", i.e. cannot hold more vertices,
-	// then return false:
-	if (this->NumVertices == this->Capacity)
+	// or frozen, then return false:
+	if (this->NumVertices == this->Capacity || this->Frozen)
 		return false;
 	
-	// if the vertex name already exists in the graph,
-	// then return false.  To determine, perform a linear
-	// search of the Names array; note that in C++ you
-	// compare strings using ==, no strcmp needed:
+	// there's room to add another vertex, so grab next index;
+	// if the vertex name already exists in the graph, we return
+	// false:
+	int i = this->NumVertices;
 
-	if (this->FindVertexByName(v) != -1)
+	if (this->Names.Find(v) != -1)
 		return false;
 
-	// there's room to add another vertex, so grab next index
-	// and initialize that linked-list to empty, and store
-	// vertex's name:
-	int i = this->NumVertices;
+	// initialize that linked-list to empty, and intern the
+	// vertex's name, whose id is then i:
 
-	this->Vertices[i] = nullptr;	// head of LL: null
-	this->Names[i] = v;				// copy vertex string:
+	this->Vertices[i] = NoEdge;		// head of LL: none
+	this->Names.Intern(v);			// copy vertex string:
 
 	this->NumVertices++;			// update the vertices count
 	return true;					// update succesful
@@ -149,13 +274,17 @@ bool Graph::AddVertex(string v)
 //
 // Adds an edge from src to dest, with the given weight, returning
 // true if successful and false if not.  The add fails if the src
-// or dest vertex do not exist.
+// or dest vertex do not exist, or the graph is frozen.
 //
-bool Graph::AddEdge(string src, string dest, int weight)
+template <typename V, typename W>
+bool BasicGraph<V, W>::AddEdge(string_view src, string_view dest, int weight)
 {
 	int S = -1;
 	int D = -1;
 
+	if (this->Frozen)
+		return false;
+
 	// First, lookup src vertex in Names array and obtain index S;
 	// if not found, return false:
 	S = this->FindVertexByName(src);
@@ -168,46 +297,82 @@ bool Graph::AddEdge(string src, string dest, int weight)
 	if (D == -1)
 		return false;
 
-	// Now add an edge (S,D,weight) to the front of S's linked-list.
-	// You'll need to allocate a new edge using new, store S, D and
-	// weight, and then insert at head of S's linked-list in the
-	// Vertices array:
-	Edge *e = new Edge();
-	e->Src = S;
-	e->Dest = D;
-	e->Weight = weight;
-	e->Next = NULL;
+	return this->AddEdge(S, D, weight);
+}
+
+
+//
+// AddEdge:
+//
+// Same as above, but by vertex #.  Fails if S or D is not a vertex
+// of the graph, or the graph is frozen.
+//
+template <typename V, typename W>
+bool BasicGraph<V, W>::AddEdge(int S, int D, int weight)
+{
+	STAT_TIMER(timer, Stat::AddEdge);
+
+	if (this->Frozen)
+		return false;
+
+	if (S < 0 || S >= this->NumVertices || D < 0 || D >= this->NumVertices)
+		return false;
+
+	// the list links are 32-bit arena indices
+	if (this->Edges.Size() >= NoEdge)
+		return false;
+
+	// Now add an edge (S,D,weight) to S's sorted linked-list.
+	// The edge is carved out of the graph's arena, store D and
+	// weight (S is implied by the list), and then insert into S's
+	// linked-list in the Vertices array:
+	uint32_t i = (uint32_t)this->Edges.Size();
+	Edge    *e = this->Edges.New();
+	e->Dest = (V)D;
+	e->Weight = (W)weight;
+	e->Next = NoEdge;
 
-	Edge *cur = this->Vertices[S];
-	Edge *prev = NULL;
+	uint32_t cur = this->Vertices[S];
+	Edge    *prev = nullptr;
+
+	this->OutTrips[S] += weight;
+	this->InTrips[D] += weight;
 
 	// empty LL
-	if (cur == NULL) {
-		this->Vertices[S] = e;
+	if (cur == NoEdge) {
+		this->Vertices[S] = i;
+		this->OutDegree[S]++;
+		this->InDegree[D]++;
 		this->NumEdges++;
 		return true;
 	}
 
 	// find the spot to insert
-	while (cur != NULL && cur->Dest < D) {
-		prev = cur;
-		cur = cur->Next;
+	while (cur != NoEdge && (int)this->Edges[cur].Dest < D) {
+		prev = &this->Edges[cur];
+		cur = prev->Next;
+	}
+
+	// first edge from S to D
+	if (cur == NoEdge || (int)this->Edges[cur].Dest != D) {
+		this->OutDegree[S]++;
+		this->InDegree[D]++;
 	}
 
 	// adjust the spot if the same destinations
-	while (cur != NULL && cur->Dest == D && cur->Weight < weight) {
-		prev = cur;
-		cur = cur->Next;
+	while (cur != NoEdge && (int)this->Edges[cur].Dest == D && this->Edges[cur].Weight < e->Weight) {
+		prev = &this->Edges[cur];
+		cur = prev->Next;
 	}
 	
 	// insert at front
-	if (prev == NULL) {
+	if (prev == nullptr) {
 		e->Next = this->Vertices[S];
-		this->Vertices[S] = e;
+		this->Vertices[S] = i;
 	}
 	// insert in the middle or at the end
 	else {
-		prev->Next = e;
+		prev->Next = i;
 		e->Next = cur;
 	}
 
@@ -220,34 +385,45 @@ bool Graph::AddEdge(string src, string dest, int weight)
 //
 // PrintGraph:
 //
-// Prints the graph, typically for debugging purposes.
+// Prints the graph to out, typically for debugging purposes.
 //
-void Graph::PrintGraph(string title)
+template <typename V, typename W>
+void BasicGraph<V, W>::PrintGraph(string title, ostream& out)
 {
 	// display stats about the graph
-	cout << ">>Graph: " << title << endl;
-	cout << "  # of vertices: " << this->NumVertices << endl;
-	cout << "  # of edges:    " << this->NumEdges << endl;
-	cout << "  Capacity:      " << this->Capacity << endl;
+	out << ">>Graph: " << title << '\n';
+	out << "  # of vertices: " << this->NumVertices << '\n';
+	out << "  # of edges:    " << this->NumEdges << '\n';
+	out << "  Capacity:      " << this->Capacity << '\n';
 
-	cout << "  Vertices:" << endl;
+	out << "  Vertices:" << '\n';
 
 	// display each vertex along with his adjacent Edges
 	for (int v = 0; v < this->NumVertices; ++v)
 	{
-		cout << "    " << v << " (" << this->Names[v] << "): ";
+		out << "    " << v << " (" << this->Names.Get(v) << "): ";
 
-		Edge *edge = this->Vertices[v];
-		while (edge != nullptr)
-		{
-			cout << "(" << edge->Src << "," << edge->Dest << "," << edge->Weight << ")";
+		if (this->Frozen) {
+			for (int e = this->Offsets[v]; e < this->Offsets[v + 1]; e++) {
+				if (e > this->Offsets[v])
+					out << ", ";
+				out << "(" << v << "," << this->Dests[e] << "," << this->Weights[e] << ")";
+			}
 
-			edge = edge->Next;
-			if (edge != nullptr)
-				cout << ", ";
+			out << '\n';
+			continue;
 		}
 
-		cout << endl;
+		bool first = true;
+		for (Neighbor n : this->Neighbors(v))
+		{
+			if (!first)
+				out << ", ";
+			out << "(" << v << "," << n.Dest << "," << n.Weight << ")";
+			first = false;
+		}
+
+		out << '\n';
 	}
 }
 
@@ -256,19 +432,27 @@ void Graph::PrintGraph(string title)
 // FindVertexByName:
 //
 // Helper function to find a vertex by name by
-// searching the Names array using linear search.
+// probing the name index, O(1) on average.
 // Returns vertex # (i.e. array index) or -1 if 
 // not found:
 //
-int Graph::FindVertexByName(string name)
+template <typename V, typename W>
+int BasicGraph<V, W>::FindVertexByName(string_view name)
 {
-	// search for vertex
-	for (int i = 0; i < this->NumVertices; i++) {
-		if (this->Names[i] == name)
-			return i;		// found, return vertex #
-	}
+	STAT_TIMER(timer, Stat::FindVertexByName);
 
-	return -1;				// not found
+	return this->Names.Find(name);
+}
+
+
+//
+// returns the name of vertex v, or empty string if v does not exist;
+// the view stays valid as long as the graph
+//
+template <typename V, typename W>
+string_view BasicGraph<V, W>::GetName(int v)
+{
+	return this->Names.Get(v);
 }
 
 
@@ -277,13 +461,14 @@ int Graph::FindVertexByName(string name)
 //
 // Returns a set containing all vertices in the graph.
 //
-set<string> Graph::GetVertices()
+template <typename V, typename W>
+set<string> BasicGraph<V, W>::GetVertices()
 {
 	set<string>  vertices;
 
 	// traverse the graph and build set with all vertices
 	for (int i = 0; i < this->NumVertices; i++) {
-		vertices.insert(this->Names[i]);
+		vertices.insert(string(this->Names.Get(i)));
 	}
 
 	return vertices;		// return vertices set
@@ -297,54 +482,111 @@ set<string> Graph::GetVertices()
 // If v does not exist in the graph, the returned set is
 // empty.
 //
-set<string> Graph::GetNeighbors(string v)
+template <typename V, typename W>
+set<string> BasicGraph<V, W>::GetNeighbors(string_view v)
 {
 	set<string>  neighbors;
 
 	// find vertex id
 	int index = FindVertexByName(v);
 
-	if (index != -1) {
+	// traverse and add to set
+	for (Neighbor n : this->Neighbors(index))
+		neighbors.insert(string(this->Names.Get(n.Dest)));
+
+	return neighbors;		// return neighbors set
+}
+
+
+//
+// Neighbors:
+//
+// Returns the out-edges of v as a range to iterate over, in ascending
+// destination order; empty if v does not exist.  Nothing is copied or
+// allocated.  The range is valid until the graph changes.
+//
+template <typename V, typename W>
+typename BasicGraph<V, W>::NeighborRange BasicGraph<V, W>::Neighbors(int v)
+{
+	if (v < 0 || v >= this->NumVertices)
+		return NeighborRange(NeighborIterator(nullptr, nullptr, nullptr, NoEdge),
+			NeighborIterator(nullptr, nullptr, nullptr, NoEdge));
 
-		// temporary Edge
-		Edge *cur = this->Vertices[index];
+	if (this->Frozen) {
+		const V *dests = this->Dests.data();
+		const W *weights = this->Weights.data();
 
-		// traverse and add to set
-		while (cur != NULL) {
-			index = FindVertexByName(this->Names[cur->Dest]);
-			neighbors.insert(this->Names[index]);
-			cur = cur->Next;
-		}
+		return NeighborRange(NeighborIterator(dests + this->Offsets[v], weights + this->Offsets[v], nullptr, NoEdge),
+			NeighborIterator(dests + this->Offsets[v + 1], weights + this->Offsets[v + 1], nullptr, NoEdge));
 	}
 
-	return neighbors;		// return neighbors set
+	return NeighborRange(NeighborIterator(nullptr, nullptr, &this->Edges, this->Vertices[v]),
+		NeighborIterator(nullptr, nullptr, &this->Edges, NoEdge));
 }
 
 
 //
 // counts total trips from the given source Station
 //
-int Graph::CountTrips(string name) 
+template <typename V, typename W>
+int BasicGraph<V, W>::CountTrips(string_view name) 
 {
-	int count = 0;
-
 	// find vertex id
 	int index = FindVertexByName(name);
 
-	// if station exist
-	if (index != -1) {
+	return (index != -1) ? this->OutTrips[index] : 0;
+}
 
-		// temporary Edge
-		Edge *cur = this->Vertices[index];
 
-		// traverse neighbors and accumulate total trips
-		while (cur != NULL) {
-			count += cur->Weight;	// add weight
-			cur = cur->Next;		// forward to the next node 
-		}
-	}
-		
-	return count;					// return number of neighbors
+//
+// # of distinct destinations of vertex v, 0 if no such vertex
+//
+template <typename V, typename W>
+int BasicGraph<V, W>::GetOutDegree(int v)
+{
+	if (v < 0 || v >= this->NumVertices)
+		return 0;
+
+	return this->OutDegree[v];
+}
+
+
+//
+// total weight of the edges out of vertex v, 0 if no such vertex
+//
+template <typename V, typename W>
+int BasicGraph<V, W>::GetOutTrips(int v)
+{
+	if (v < 0 || v >= this->NumVertices)
+		return 0;
+
+	return this->OutTrips[v];
+}
+
+
+//
+// # of distinct sources of vertex v, 0 if no such vertex
+//
+template <typename V, typename W>
+int BasicGraph<V, W>::GetInDegree(int v)
+{
+	if (v < 0 || v >= this->NumVertices)
+		return 0;
+
+	return this->InDegree[v];
+}
+
+
+//
+// total weight of the edges into vertex v, 0 if no such vertex
+//
+template <typename V, typename W>
+int BasicGraph<V, W>::GetInTrips(int v)
+{
+	if (v < 0 || v >= this->NumVertices)
+		return 0;
+
+	return this->InTrips[v];
 }
 
 
@@ -358,26 +600,33 @@ int Graph::CountTrips(string name)
 // weight).  If src or dest do not exist in the graph, the
 // returned vector is empty.
 //
-vector<int> Graph::GetEdgeWeights(string src, string dest)
+template <typename V, typename W>
+vector<int> BasicGraph<V, W>::GetEdgeWeights(string_view src, string_view dest)
 {
 	vector<int> weights;	// weights
 
 	// find vertex ID
 	int srcID = FindVertexByName(src);
 	
-	// if source Station exists
-	if (srcID != -1) {
-
-		// temp Edge
-		Edge *cur = this->Vertices[srcID];
+	// if source Station exists and graph is frozen, equal destinations
+	// are adjacent and already in ascending weight order
+	if (srcID != -1 && this->Frozen) {
 		int destID = FindVertexByName(dest);
+		int e = this->FindEdge(srcID, destID);
 
-		// traverse and add to vector if cur->Dest matches destID
-		while (cur != NULL) {
-			if (destID == cur->Dest)
-				weights.push_back(cur->Weight);		// add to vector
+		while (e != -1 && e < this->Offsets[srcID + 1] && (int)this->Dests[e] == destID) {
+			weights.push_back(this->Weights[e]);	// add to vector
+			e++;
+		}
+	}
+	else if (srcID != -1) {
 
-			cur = cur->Next;		// go to the next node
+		int destID = FindVertexByName(dest);
+
+		// traverse and add to vector if the destination matches destID
+		for (Neighbor n : this->Neighbors(srcID)) {
+			if (destID == n.Dest)
+				weights.push_back(n.Weight);		// add to vector
 		}
 	}
 
@@ -388,24 +637,16 @@ vector<int> Graph::GetEdgeWeights(string src, string dest)
 //
 // traverse the linked list and returns the vector with adjacent neighbors
 //
-vector<int> Graph::iNeighbors(int v) 
+template <typename V, typename W>
+vector<int> BasicGraph<V, W>::iNeighbors(int v) 
 {
 
 	vector<int>  neighbors;		// vector with neighbors
 
-	// find vertex id
-	int index = FindVertexByName(this->Names[v]);
-
-	// if vertex exist
-	if (index != -1) {
-		// temp edge 
-		Edge *cur = this->Vertices[index];
-		// traverse linked list with neighbors and add their IDs to the vector
-		while (cur != NULL) {
-			neighbors.push_back(cur->Dest);
-			cur = cur->Next;
-		}
-	}
+	// add the neighbors' IDs to the vector; Neighbors() walks them
+	// without the copy
+	for (Neighbor n : this->Neighbors(v))
+		neighbors.push_back(n.Dest);
 
 	return neighbors;		// return neighbors vector
 }
@@ -414,22 +655,34 @@ vector<int> Graph::iNeighbors(int v)
 //
 // finds and return egge weight
 //
-int Graph::GetEdgeWeight(string srcName, string destName) 
+template <typename V, typename W>
+int BasicGraph<V, W>::GetEdgeWeight(string_view srcName, string_view destName) 
 {
-	
 	// grab source and destination IDs
-	int srcIndex = FindVertexByName(srcName);
-	int destIndex = FindVertexByName(destName);
+	return this->GetEdgeWeight(FindVertexByName(srcName), FindVertexByName(destName));
+}
 
-	// temp Edge
-	Edge *cur = this->Vertices[srcIndex];
-	
-	// traverse linked list
-	while (cur != NULL) {
-		if (cur->Dest == destIndex)
-			return cur->Weight;		// found
 
-		cur = cur->Next;			// forward to the next node
+//
+// same, by vertex #; 0 if there is no such edge
+//
+template <typename V, typename W>
+int BasicGraph<V, W>::GetEdgeWeight(int srcIndex, int destIndex)
+{
+	// source does not exist
+	if (srcIndex < 0 || srcIndex >= this->NumVertices)
+		return 0;
+
+	// frozen: binary search the source's edges
+	if (this->Frozen) {
+		int e = this->FindEdge(srcIndex, destIndex);
+		return (e != -1) ? this->Weights[e] : 0;
+	}
+
+	// traverse linked list
+	for (Neighbor n : this->Neighbors(srcIndex)) {
+		if (n.Dest == destIndex)
+			return n.Weight;		// found
 	}
 
 	return 0;						// not found
@@ -437,48 +690,519 @@ int Graph::GetEdgeWeight(string srcName, string destName)
 
 
 //
-// performs BFS and return the vector of stations IDs
+// performs BFS and return the vector of stations names
 // in order they were visited 
 //
-vector<string> Graph::BFS(string v)	{
+template <typename V, typename W>
+vector<string> BasicGraph<V, W>::BFS(string_view v)	{
 
 	vector<string>  visited;		
-	queue<int>		frontierQueue;	 
-	set<int>		discoveredSet;	
 
-	// grab the start vertex index
-	int start = FindVertexByName(v);
+	// run the id-based BFS and map the vertices to names
+	for (int curV : this->BFS(FindVertexByName(v)))
+		visited.push_back(string(this->Names.Get(curV)));
+
+	return visited;				// return vector with visited
+}
+
+
+//
+// performs BFS from vertex # start and returns the vertex #'s in
+// order they were visited, empty if start does not exist.  The
+// visited vector doubles as the frontier queue, and discovered
+// vertices are tracked in a dense bitmap.
+//
+template <typename V, typename W>
+vector<int> BasicGraph<V, W>::BFS(int start)	{
+
+	STAT_TIMER(timer, Stat::BFS);
+
+	vector<int>       visited;		
+	vector<uint64_t>  discovered((this->NumVertices + 63) / 64, 0);
 
 	// vertex does not exist
-	if (start < 0)
+	if (start < 0 || start >= this->NumVertices)
 		return visited;
 
+	visited.reserve(this->NumVertices);
+
 	// start BFS,
-	// push start into frontierQueue and discoveredSet
-	frontierQueue.push(start);
-	discoveredSet.insert(start);
-
-	// while frontierQueue is not empty
-	while (!frontierQueue.empty()) {
-		// assign front value to curV and pop it from frontierQueue
-		int curV = frontierQueue.front();		
-		frontierQueue.pop();
-
-		// get the vector with neighbors
-		vector<int> intNeighbors = iNeighbors(curV);
-
-		// puch curV name into visited vector
-		visited.push_back(this->Names[curV]);
-
-		// traverse alkl neighbors
-		for (int adjV : intNeighbors) {
-			// if not in discovedSet, push into frontierQueue and into discoveredSet
-			if (discoveredSet.find(adjV) == discoveredSet.end()) {
-				frontierQueue.push(adjV);
-				discoveredSet.insert(adjV);
+	// push start into the queue and mark it discovered
+	visited.push_back(start);
+	discovered[start >> 6] |= 1ull << (start & 63);
+
+	// while the queue is not empty
+	for (size_t head = 0; head < visited.size(); head++) {
+		int curV = visited[head];
+
+		// if not discovered, push into the queue and mark it
+		auto discover = [&](int adjV) {
+			uint64_t bit = 1ull << (adjV & 63);
+			if (!(discovered[adjV >> 6] & bit)) {
+				discovered[adjV >> 6] |= bit;
+				visited.push_back(adjV);
 			}
+		};
+
+		// traverse all neighbors
+		if (this->Frozen) {
+			for (int e = this->Offsets[curV]; e < this->Offsets[curV + 1]; e++)
+				discover(this->Dests[e]);
+		}
+		else {
+			for (uint32_t cur = this->Vertices[curV]; cur != NoEdge; cur = this->Edges[cur].Next)
+				discover(this->Edges[cur].Dest);
 		}
 	}
 
 	return visited;				// return vector with visited
-}
\ No newline at end of file
+}
+
+
+//
+// FindEdge:
+//
+// Binary searches the frozen edges of src for dest, returning the
+// position of the first such edge or -1 if there is none (or the
+// graph is not frozen).
+//
+template <typename V, typename W>
+int BasicGraph<V, W>::FindEdge(int src, int dest)
+{
+	if (!this->Frozen || src < 0 || src >= this->NumVertices || dest < 0)
+		return -1;
+
+	auto first = this->Dests.begin() + this->Offsets[src];
+	auto last = this->Dests.begin() + this->Offsets[src + 1];
+	auto it = lower_bound(first, last, dest);
+
+	if (it == last || (int)*it != dest)
+		return -1;				// not found
+
+	return (int)(it - this->Dests.begin());
+}
+
+
+//
+// Freeze:
+//
+// Compacts the adjacency lists into compressed sparse row arrays
+// (Offsets, Dests, Weights) and frees the list nodes in bulk.  Each list is
+// already ordered by destination, so the copy stays sorted.  The
+// aggregates and the connected components are derived from the copy.
+// Once frozen, the graph is read-only: AddVertex, AddEdge and
+// UpdateWeight fail, and every query runs over contiguous memory.
+//
+template <typename V, typename W>
+void BasicGraph<V, W>::Freeze()
+{
+	if (this->Frozen)
+		return;
+
+	this->Offsets.assign(this->NumVertices + 1, 0);
+	this->Dests.clear();
+	this->Weights.clear();
+	this->Dests.reserve(this->NumEdges);
+	this->Weights.reserve(this->NumEdges);
+
+	for (int v = 0; v < this->NumVertices; v++) {
+		this->Offsets[v] = (int)this->Dests.size();
+
+		uint32_t cur = this->Vertices[v];
+		while (cur != NoEdge) {
+			const Edge& e = this->Edges[cur];
+			this->Dests.push_back(e.Dest);
+			this->Weights.push_back(e.Weight);
+			cur = e.Next;
+		}
+
+		this->Vertices[v] = NoEdge;
+	}
+
+	this->Edges.Release();
+
+	this->Offsets[this->NumVertices] = (int)this->Dests.size();
+	this->BuildAggregates();
+	this->BuildComponents();
+	this->Frozen = true;
+}
+
+
+// true once Freeze() has been called
+template <typename V, typename W>
+bool BasicGraph<V, W>::IsFrozen()
+{
+	return this->Frozen;
+}
+
+
+//
+// LoadFrozen:
+//
+// Installs ready-made CSR arrays (e.g. from a snapshot) over the
+// vertices already added, and freezes the graph.  offsets holds
+// NumVertices+1 entries, dests and weights numEdges each.  Fails,
+// leaving the graph untouched, if the graph already has edges or the
+// arrays are inconsistent.
+//
+template <typename V, typename W>
+bool BasicGraph<V, W>::LoadFrozen(const int *offsets, const int *dests, const int *weights, int numEdges)
+{
+	if (this->Frozen || this->NumEdges != 0 || numEdges < 0)
+		return false;
+
+	// offsets must run from 0 to numEdges without going backwards
+	if (offsets[0] != 0 || offsets[this->NumVertices] != numEdges)
+		return false;
+	for (int v = 0; v < this->NumVertices; v++) {
+		if (offsets[v] > offsets[v + 1])
+			return false;
+	}
+
+	// every destination must be a vertex
+	for (int e = 0; e < numEdges; e++) {
+		if (dests[e] < 0 || dests[e] >= this->NumVertices)
+			return false;
+	}
+
+	this->Offsets.assign(offsets, offsets + this->NumVertices + 1);
+	this->Dests.assign(dests, dests + numEdges);
+	this->Weights.assign(weights, weights + numEdges);
+	this->NumEdges = numEdges;
+	this->BuildAggregates();
+	this->BuildComponents();
+	this->Frozen = true;
+	return true;
+}
+
+
+// getters for the frozen arrays, empty until the graph is frozen
+template <typename V, typename W>
+const vector<int>& BasicGraph<V, W>::GetOffsets()
+{
+	return this->Offsets;
+}
+
+template <typename V, typename W>
+const vector<V>& BasicGraph<V, W>::GetDests()
+{
+	return this->Dests;
+}
+
+template <typename V, typename W>
+const vector<W>& BasicGraph<V, W>::GetWeights()
+{
+	return this->Weights;
+}
+
+
+//
+// edges of v in destination name order, one per destination (the
+// first, as FindEdge finds it):
+//   GetNameOrder()[GetOffsets()[v] .. GetOffsets()[v] + GetOutDegree(v))
+// Empty until the graph is frozen.
+//
+template <typename V, typename W>
+const vector<int>& BasicGraph<V, W>::GetNameOrder()
+{
+	return this->NameOrder;
+}
+
+
+//
+// reverse adjacency: one in-edge per distinct source of v, by source
+// name, in
+//   [GetInOffsets()[v], GetInOffsets()[v+1])
+// of GetInSources() (source vertex #) and GetInEdges() (the forward
+// edge #, for its weight).  Empty until the graph is frozen.
+//
+template <typename V, typename W>
+const vector<int>& BasicGraph<V, W>::GetInOffsets()
+{
+	return this->InOffsets;
+}
+
+template <typename V, typename W>
+const vector<V>& BasicGraph<V, W>::GetInSources()
+{
+	return this->InSources;
+}
+
+template <typename V, typename W>
+const vector<int>& BasicGraph<V, W>::GetInEdges()
+{
+	return this->InEdges;
+}
+
+
+//
+// connected components over the trip edges: per vertex, the # of its
+// strongly (weakly) connected component, and per component its # of
+// vertices.  Components are numbered largest first.  Two stations are
+// reachable from one another iff their SCCs match, and neither reaches
+// the other if their WCCs differ.  Empty until the graph is frozen.
+//
+template <typename V, typename W>
+const vector<V>& BasicGraph<V, W>::GetSCCs()
+{
+	return this->SCCs;
+}
+
+template <typename V, typename W>
+const vector<int>& BasicGraph<V, W>::GetSCCSizes()
+{
+	return this->SCCSizes;
+}
+
+template <typename V, typename W>
+const vector<V>& BasicGraph<V, W>::GetWCCs()
+{
+	return this->WCCs;
+}
+
+template <typename V, typename W>
+const vector<int>& BasicGraph<V, W>::GetWCCSizes()
+{
+	return this->WCCSizes;
+}
+
+
+//
+// BuildAggregates:
+//
+// Derives the per-vertex aggregates, the name order and the reverse
+// adjacency from the CSR arrays.  Names are ranked once, so the
+// per-vertex sorts compare ints.
+//
+template <typename V, typename W>
+void BasicGraph<V, W>::BuildAggregates()
+{
+	vector<int> byName(this->NumVertices);
+	vector<int> rank(this->NumVertices);
+
+	for (int v = 0; v < this->NumVertices; v++)
+		byName[v] = v;
+	sort(byName.begin(), byName.end(),
+		[this](int a, int b) { return this->Names.Get(a) < this->Names.Get(b); });
+	for (int r = 0; r < this->NumVertices; r++)
+		rank[byName[r]] = r;
+
+	this->NameOrder.resize(this->Dests.size());
+
+	for (int v = 0; v < this->NumVertices; v++) {
+		int begin = this->Offsets[v];
+		int n = 0, trips = 0;
+
+		// first edge to each destination; dests are sorted per vertex
+		for (int e = begin; e < this->Offsets[v + 1]; e++) {
+			if (e == begin || this->Dests[e] != this->Dests[e - 1])
+				this->NameOrder[begin + n++] = e;
+			trips += this->Weights[e];
+		}
+
+		sort(this->NameOrder.begin() + begin, this->NameOrder.begin() + begin + n,
+			[&](int a, int b) { return rank[this->Dests[a]] < rank[this->Dests[b]]; });
+
+		// duplicates, after the distinct ones
+		for (int e = begin, i = n; e < this->Offsets[v + 1]; e++) {
+			if (e != begin && this->Dests[e] == this->Dests[e - 1])
+				this->NameOrder[begin + i++] = e;
+		}
+
+		this->OutDegree[v] = n;
+		this->OutTrips[v] = trips;
+	}
+
+	//
+	// reverse adjacency: count the distinct in-edges, prefix sum, then
+	// scatter the sources in name order so every in-list comes out
+	// sorted by name
+	//
+	this->InOffsets.assign(this->NumVertices + 1, 0);
+	this->InTrips.assign(this->Capacity, 0);
+
+	for (int v = 0; v < this->NumVertices; v++) {
+		for (int i = this->Offsets[v]; i < this->Offsets[v] + this->OutDegree[v]; i++)
+			this->InOffsets[this->Dests[this->NameOrder[i]] + 1]++;
+		for (int e = this->Offsets[v]; e < this->Offsets[v + 1]; e++)
+			this->InTrips[this->Dests[e]] += this->Weights[e];
+	}
+	for (int v = 0; v < this->NumVertices; v++) {
+		this->InDegree[v] = this->InOffsets[v + 1];
+		this->InOffsets[v + 1] += this->InOffsets[v];
+	}
+
+	vector<int> fill(this->InOffsets.begin(), this->InOffsets.end() - 1);
+	this->InSources.resize(this->InOffsets[this->NumVertices]);
+	this->InEdges.resize(this->InOffsets[this->NumVertices]);
+
+	for (int u : byName) {
+		for (int i = this->Offsets[u]; i < this->Offsets[u] + this->OutDegree[u]; i++) {
+			int e = this->NameOrder[i];
+			int slot = fill[this->Dests[e]]++;
+
+			this->InSources[slot] = (V)u;
+			this->InEdges[slot] = e;
+		}
+	}
+}
+
+
+
+//
+// renumbers the components of ids (numbered 0 .. count-1) largest
+// first, ties by lowest vertex, storing them in comps and their sizes
+// in sizes
+//
+template <typename V>
+static void RankComponents(const vector<int>& ids, int count, vector<V>& comps, vector<int>& sizes)
+{
+	int         n = (int)ids.size();
+	vector<int> size(count, 0), first(count, -1), order(count), rank(count);
+
+	for (int v = 0; v < n; v++) {
+		if (first[ids[v]] == -1)
+			first[ids[v]] = v;
+		size[ids[v]]++;
+	}
+
+	for (int c = 0; c < count; c++)
+		order[c] = c;
+	sort(order.begin(), order.end(), [&](int a, int b) {
+		return (size[a] != size[b]) ? size[a] > size[b] : first[a] < first[b];
+	});
+
+	sizes.resize(count);
+	for (int r = 0; r < count; r++) {
+		rank[order[r]] = r;
+		sizes[r] = size[order[r]];
+	}
+
+	comps.resize(n);
+	for (int v = 0; v < n; v++)
+		comps[v] = (V)rank[ids[v]];
+}
+
+
+//
+// BuildComponents:
+//
+// Finds the strongly connected components with Tarjan's algorithm,
+// run iteratively (an explicit call stack of vertex and next edge) so
+// long paths cannot overflow the stack, and the weakly connected ones
+// with union-find over every edge.  Runs over the CSR arrays, in
+// O(V + E).
+//
+template <typename V, typename W>
+void BasicGraph<V, W>::BuildComponents()
+{
+	STAT_TIMER(timer, Stat::BuildComponents);
+
+	int n = this->NumVertices;
+
+	//
+	// Tarjan: a vertex still without a component once visited is on
+	// the stack of the current search
+	//
+	vector<int> visitOrder(n, -1), low(n), scc(n, -1);
+	vector<int> stack, callV, callE;
+	int         visited = 0, numSCCs = 0;
+
+	for (int s = 0; s < n; s++) {
+		if (visitOrder[s] != -1)
+			continue;
+
+		visitOrder[s] = low[s] = visited++;
+		stack.push_back(s);
+		callV.push_back(s);
+		callE.push_back(this->Offsets[s]);
+
+		while (!callV.empty()) {
+			int v = callV.back();
+			int e = callE.back();
+
+			// next edge of v: descend into a new vertex, or lower v's
+			// link through one on the stack
+			if (e < this->Offsets[v + 1]) {
+				int w = this->Dests[e];
+				callE.back()++;
+
+				if (visitOrder[w] == -1) {
+					visitOrder[w] = low[w] = visited++;
+					stack.push_back(w);
+					callV.push_back(w);
+					callE.push_back(this->Offsets[w]);
+				}
+				else if (scc[w] == -1) {
+					low[v] = min(low[v], visitOrder[w]);
+				}
+				continue;
+			}
+
+			// v is done: it roots a component if nothing below it links
+			// higher up
+			callV.pop_back();
+			callE.pop_back();
+
+			if (low[v] == visitOrder[v]) {
+				int w;
+				do {
+					w = stack.back();
+					stack.pop_back();
+					scc[w] = numSCCs;
+				} while (w != v);
+				numSCCs++;
+			}
+
+			if (!callV.empty())
+				low[callV.back()] = min(low[callV.back()], low[v]);
+		}
+	}
+
+	//
+	// union-find, by size with path halving
+	//
+	vector<int> parent(n), size(n, 1);
+	for (int v = 0; v < n; v++)
+		parent[v] = v;
+
+	auto find = [&](int v) {
+		while (parent[v] != v) {
+			parent[v] = parent[parent[v]];
+			v = parent[v];
+		}
+		return v;
+	};
+
+	for (int v = 0; v < n; v++) {
+		for (int e = this->Offsets[v]; e < this->Offsets[v + 1]; e++) {
+			int a = find(v), b = find(this->Dests[e]);
+
+			if (a == b)
+				continue;
+			if (size[a] < size[b])
+				swap(a, b);
+			parent[b] = a;
+			size[a] += size[b];
+		}
+	}
+
+	// roots become dense component #'s
+	vector<int> wcc(n), rootID(n, -1);
+	int         numWCCs = 0;
+
+	for (int v = 0; v < n; v++) {
+		int root = find(v);
+		if (rootID[root] == -1)
+			rootID[root] = numWCCs++;
+		wcc[v] = rootID[root];
+	}
+
+	RankComponents(scc, numSCCs, this->SCCs, this->SCCSizes);
+	RankComponents(wcc, numWCCs, this->WCCs, this->WCCSizes);
+}
+
+
+// the widths the program is built with, see graph.h
+template class BasicGraph<uint16_t, uint32_t>;
+template class BasicGraph<uint32_t, uint32_t>;
@@ -12,54 +12,230 @@
 
 #pragma once
 
+#include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <set>
 #include <queue>
+#include <cstdint>
+#include <limits>
+
+#include "arena.h"
+#include "hashindex.h"
+#include "stringpool.h"
 
 using namespace std;
 
 //
-// Graph class
+// BasicGraph class
+//
+// A directed, weighted graph of named vertices.  V is the type a
+// vertex # is stored as, W the type of an edge weight; both are
+// unsigned integers, and the narrower they are the less memory each
+// edge takes.  The interface speaks int either way (vertex #'s, -1
+// for none), and a graph holds at most as many vertices as V can
+// number.  Instantiated in graph.cpp for the widths below.
 //
-class Graph
+template <typename V, typename W>
+class BasicGraph
 {
+public:
+	typedef V VertexType;			// stored vertex #
+	typedef W WeightType;			// stored edge weight
+
 private:
+	static constexpr uint32_t NoEdge = numeric_limits<uint32_t>::max();	// end of a list
 
-	// Edge class
+	// Edge class: a list node, linked by arena index
 	class Edge
 	{
 	public:
-		int   Src, Dest, Weight;	// source, destination, weight
-		Edge *Next;					// pointer to the next Edge
+		uint32_t Next;				// index of the next Edge, NoEdge at the end
+		W        Weight;			// weight
+		V        Dest;				// destination
 	};
 
-	Edge  **Vertices;				// vertices with Edge
-	string *Names;					// names
+	Arena<Edge> Edges;				// storage for every Edge
+	uint32_t *Vertices;				// per vertex, index of its first Edge
+	StringPool Names;				// names, interned: the id of a name is its vertex #
 	int     NumVertices;			// # of vertices in the graph
 	int     NumEdges;				// # of edges in the graph
 	int     Capacity;				// max capacity of the graph
 
+	// per-vertex aggregates, kept up to date as edges are added
+	vector<int> OutDegree;			// # of distinct destinations
+	vector<int> OutTrips;			// sum of the outgoing weights
+	vector<int> InDegree;			// # of distinct sources
+	vector<int> InTrips;			// sum of the incoming weights
+
+	// frozen (compressed sparse row) form, see Freeze()
+	bool        Frozen;				// true once the graph is frozen
+	vector<int> Offsets;			// edges of v are [Offsets[v], Offsets[v+1])
+	vector<V>   Dests;				// destination of each edge, sorted per vertex
+	vector<W>   Weights;			// weight of each edge
+	vector<int> NameOrder;			// per vertex, the first edge to each destination,
+									// by destination name (see GetNameOrder())
+	vector<int> InOffsets;			// reverse CSR, in-edges of v are
+	vector<V>   InSources;			// [InOffsets[v], InOffsets[v+1]), by source name,
+	vector<int> InEdges;			// with the matching forward edge #
+
+	// connected components, over the trip edges (see BuildComponents())
+	vector<V>   SCCs;				// per vertex, its strongly connected component
+	vector<int> SCCSizes;			// # of vertices of each
+	vector<V>   WCCs;				// per vertex, its weakly connected component
+	vector<int> WCCSizes;			// # of vertices of each
+
 	// private function prototypes
-	int FindVertexByName(string name);
+	void BuildAggregates();
+	void BuildComponents();
 
 public:
-	Graph(int N);
-	~Graph();
+
+	// Neighbor class: one out-edge, as handed out by Neighbors()
+	class Neighbor
+	{
+	public:
+		int Dest, Weight;			// destination, weight
+	};
+
+	//
+	// NeighborIterator class
+	//
+	// Walks the out-edges of a vertex without allocating: along the
+	// CSR arrays once the graph is frozen, along its list before.
+	//
+	class NeighborIterator
+	{
+	private:
+		const V           *Dest;	// frozen: current edge
+		const W           *Weight;
+		const Arena<Edge> *Edges;	// not frozen: the list nodes,
+		uint32_t           Cur;		// and the current one
+
+	public:
+		NeighborIterator(const V *dest, const W *weight, const Arena<Edge> *edges, uint32_t cur)
+		{
+			this->Dest = dest;
+			this->Weight = weight;
+			this->Edges = edges;
+			this->Cur = cur;
+		}
+
+		Neighbor operator*() const
+		{
+			if (this->Cur != NoEdge) {
+				const Edge& e = (*this->Edges)[this->Cur];
+				return Neighbor{ (int)e.Dest, (int)e.Weight };
+			}
+			return Neighbor{ (int)*this->Dest, (int)*this->Weight };
+		}
+
+		NeighborIterator& operator++()
+		{
+			if (this->Cur != NoEdge) {
+				this->Cur = (*this->Edges)[this->Cur].Next;
+			}
+			else {
+				this->Dest++;
+				this->Weight++;
+			}
+			return *this;
+		}
+
+		bool operator!=(const NeighborIterator& other) const
+		{
+			return this->Dest != other.Dest || this->Cur != other.Cur;
+		}
+	};
+
+	// NeighborRange class: the out-edges of a vertex, for range-for
+	class NeighborRange
+	{
+	private:
+		NeighborIterator First, Last;
+
+	public:
+		NeighborRange(NeighborIterator first, NeighborIterator last)
+			: First(first), Last(last)
+		{
+		}
+
+		NeighborIterator begin() const
+		{
+			return this->First;
+		}
+
+		NeighborIterator end() const
+		{
+			return this->Last;
+		}
+	};
+
+	BasicGraph(int N);
+	~BasicGraph();
+
+	// move-only: the graph owns its arrays and edges
+	BasicGraph(const BasicGraph&) = delete;
+	BasicGraph& operator=(const BasicGraph&) = delete;
+	BasicGraph(BasicGraph&& other) noexcept;
+	BasicGraph& operator=(BasicGraph&& other) noexcept;
 
 	// public function prototypes
-	void PrintGraph(string title);
-	bool AddVertex(string v);
-	bool AddEdge(string src, string dest, int weight);
+	void PrintGraph(string title, ostream& out = cout);
+	bool AddVertex(string_view v);
+	bool AddEdge(string_view src, string_view dest, int weight);
+	bool AddEdge(int S, int D, int weight);
 	set<string> GetVertices();
-	set<string> GetNeighbors(string v);
-	vector<int> GetEdgeWeights(string src, string dest);
-	vector<string> BFS(string v);
+	set<string> GetNeighbors(string_view v);
+	NeighborRange Neighbors(int v);
+	vector<int> GetEdgeWeights(string_view src, string_view dest);
+	vector<string> BFS(string_view v);
+	vector<int> BFS(int start);
 	vector<int> iNeighbors(int v);
 	int GetNumVertices();
 	int GetNumEdges();
-	bool EdgeExist(string src, string dest);
-	void UpdateWeight(string src, string dest, int weight);
-	int CountTrips(string name);
-	int GetEdgeWeight(string srcName, string destName);
-};
\ No newline at end of file
+	int GetCapacity();
+	bool EdgeExist(string_view src, string_view dest);
+	bool EdgeExist(int S, int D);
+	void UpdateWeight(string_view src, string_view dest, int weight);
+	void UpdateWeight(int S, int D, int weight);
+	int CountTrips(string_view name);
+	int GetOutDegree(int v);
+	int GetOutTrips(int v);
+	int GetInDegree(int v);
+	int GetInTrips(int v);
+	int GetEdgeWeight(string_view srcName, string_view destName);
+	int GetEdgeWeight(int S, int D);
+	int FindVertexByName(string_view name);
+	string_view GetName(int v);
+	void Freeze();
+	bool IsFrozen();
+	int FindEdge(int src, int dest);
+	bool LoadFrozen(const int *offsets, const int *dests, const int *weights, int numEdges);
+	const vector<int>& GetOffsets();
+	const vector<V>& GetDests();
+	const vector<W>& GetWeights();
+	const vector<int>& GetNameOrder();
+	const vector<int>& GetInOffsets();
+	const vector<V>& GetInSources();
+	const vector<int>& GetInEdges();
+	const vector<V>& GetSCCs();
+	const vector<int>& GetSCCSizes();
+	const vector<V>& GetWCCs();
+	const vector<int>& GetWCCSizes();
+};
+
+
+//
+// Graph:
+//
+// The Divvy graph.  A city has a few hundred stations, so 16-bit
+// vertex #'s leave plenty of room; DIVVY_WIDE_IDS switches to 32-bit
+// ones for bigger networks.
+//
+#ifdef DIVVY_WIDE_IDS
+typedef BasicGraph<uint32_t, uint32_t> Graph;
+#else
+typedef BasicGraph<uint16_t, uint32_t> Graph;
+#endif
@@ -0,0 +1,185 @@
+//
+// hashindex.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+
+
+//
+// hash functions for the supported key types
+//
+inline uint32_t HashKey(string_view key)
+{
+	// FNV-1a over the characters of the string
+	uint32_t h = 2166136261u;
+	for (unsigned char c : key) {
+		h ^= c;
+		h *= 16777619u;
+	}
+	return h;
+}
+
+inline uint32_t HashKey(const string& key)
+{
+	return HashKey(string_view(key));
+}
+
+inline uint32_t HashKey(int key)
+{
+	// integer finalizer, spreads consecutive ids over the table
+	uint32_t h = (uint32_t)key;
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35u;
+	h ^= h >> 16;
+	return h;
+}
+
+inline uint32_t HashKey(long long key)
+{
+	// 64-bit finalizer folded to 32 bits
+	uint64_t h = (uint64_t)key;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ull;
+	h ^= h >> 33;
+	return (uint32_t)h;
+}
+
+
+//
+// HashIndex class
+//
+// Open-addressed (linear probing) hash map from Key to a non-negative
+// int value, typically a vertex # or an index into a vector.  The
+// table size is a power of 2 and is kept at most half full.
+//
+template <typename Key>
+class HashIndex
+{
+private:
+
+	// Slot class
+	class Slot
+	{
+	public:
+		Key  K;						// key
+		int  Value;					// value, -1 when the slot is empty
+	};
+
+	vector<Slot> Slots;				// the table
+	int          Count;				// # of keys stored
+	uint32_t     Mask;				// table size - 1
+
+	//
+	// grows the table to hold at least n keys and reinserts every key
+	//
+	void Rehash(int n)
+	{
+		uint32_t size = 16;
+		while (size < (uint32_t)n * 2)
+			size *= 2;
+
+		vector<Slot> old;
+		old.swap(this->Slots);
+
+		this->Slots.assign(size, Slot{ Key(), -1 });
+		this->Mask = size - 1;
+		this->Count = 0;
+
+		for (Slot& s : old) {
+			if (s.Value != -1)
+				this->Insert(s.K, s.Value);
+		}
+	}
+
+public:
+	HashIndex(int n = 16)
+	{
+		this->Count = 0;
+		this->Mask = 0;
+		this->Rehash(n);
+	}
+
+	// number of keys stored
+	int Size() const
+	{
+		return this->Count;
+	}
+
+	//
+	// makes room for n keys without further rehashing
+	//
+	void Reserve(int n)
+	{
+		if ((uint32_t)n * 2 > this->Mask + 1)
+			this->Rehash(n);
+	}
+
+	//
+	// removes every key, keeps the table size
+	//
+	void Clear()
+	{
+		for (Slot& s : this->Slots)
+			s.Value = -1;
+		this->Count = 0;
+	}
+
+	//
+	// inserts key with the given value, returns false if the key
+	// already exists (the stored value is not changed)
+	//
+	bool Insert(const Key& key, int value)
+	{
+		if ((uint32_t)(this->Count + 1) * 2 > this->Mask + 1)
+			this->Rehash(this->Count + 1);
+
+		uint32_t i = HashKey(key) & this->Mask;
+
+		// probe until an empty slot or the key is found
+		while (this->Slots[i].Value != -1) {
+			if (this->Slots[i].K == key)
+				return false;		// already there
+			i = (i + 1) & this->Mask;
+		}
+
+		this->Slots[i].K = key;
+		this->Slots[i].Value = value;
+		this->Count++;
+		return true;
+	}
+
+	//
+	// returns the value stored for key, or -1 if not found
+	//
+	int Find(const Key& key) const
+	{
+		uint32_t i = HashKey(key) & this->Mask;
+
+		while (this->Slots[i].Value != -1) {
+			if (this->Slots[i].K == key)
+				return this->Slots[i].Value;	// found
+			i = (i + 1) & this->Mask;
+		}
+
+		return -1;					// not found
+	}
+};
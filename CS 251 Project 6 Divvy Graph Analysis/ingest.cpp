@@ -0,0 +1,447 @@
+//
+// ingest.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <string_view>
+#include <thread>
+#include <atomic>
+#include <filesystem>
+#include <cstdlib>
+
+#include "csvscanner.h"
+#include "ingest.h"
+#include "snapshot.h"
+#include "stats.h"
+#include "tripfiles.h"
+
+using namespace std;
+
+
+
+//
+// returns the # of records (lines after the column headers) in the
+// given file, 0 if it cannot be opened; used to size the graph
+//
+int CountRecords(string filename)
+{
+	string_view line;
+	int         count = 0;
+
+	MappedFile file;
+	if (!file.Open(filename))
+		return 0;
+
+	CsvScanner input(file.Data(), file.Size());
+
+	input.NextLine(line);		// skip first line: column headers
+	while (input.NextLine(line))
+		count++;
+
+	return count;
+}
+
+
+//
+// Inputs the stations from the given file, adding each station name as a
+// vertex to the graph, and storing a new Station object into the vector.
+// The graph is passed by reference --- note the & --- so that the changes
+// made by the function are returned back.  The vector of Station objects is
+// returned by the function, and the station index is built over it.
+//
+vector<Station> InputStations(Graph& G, string filename, StationIndex& index)
+{
+	STAT_TIMER(timer, Stat::InputStations);
+
+	string_view line;		// input line
+	vector<Station> V;		// stations Vector
+
+	// verify if file was succesfully mapped
+	MappedFile file;
+	if (!file.Open(filename))	// failed to open:
+		return V;
+
+	CsvScanner input(file.Data(), file.Size());
+
+	input.NextLine(line);		// skip first line: column headers
+
+	while (input.NextLine(line))	// for each line of input:
+	{
+		// format:
+		//   id,name,latitude,longitude,dpcapacity,online_date
+		//   456,2112 W Peterson Ave,41.991178,-87.683593,15,5/12/2015
+		//   101,63rd St Beach,41.78101637,-87.57611976,23,4/20/2015
+		//
+		string_view fields[6];
+		int    stationID, capacity;
+		double latitude, longitude;
+
+		//
+		// parse the line, skipping blank or malformed lines:
+		//
+		if (CsvScanner::Split(line, fields, 6) < 5
+			|| !CsvScanner::ParseInt(fields[0], stationID)
+			|| !CsvScanner::ParseDouble(fields[2], latitude)
+			|| !CsvScanner::ParseDouble(fields[3], longitude)
+			|| !CsvScanner::ParseInt(fields[4], capacity))
+			continue;
+
+		string name(fields[1]);
+
+		//
+		// Create a new station object:
+		//
+		Station S(name,
+			stationID,
+			latitude,
+			longitude,
+			capacity);
+
+
+		// add station object to vector
+		V.push_back(S);
+
+		// add vertex to graph, which interns its own copy of the name
+		G.AddVertex(fields[1]);
+	}
+
+	// sort the vector
+	sort(V.begin(), V.end(),
+		[](const Station& s1, const Station& s2) {
+
+		if (s1.ID < s2.ID) {
+			return true;
+		}
+		else
+			return false;
+	});
+
+	// index the sorted vector by station id and by vertex
+	index.Build(V, G);
+
+	STAT_ITEMS(timer, V.size());
+	return V;		// return the vector
+}
+
+
+//
+// Inputs the trips, adding / updating the edges in the graph.  The graph is
+// passed by reference --- note the & --- so that the changes made by the 
+// function are returned back.  The station index maps each station id to
+// its vertex in O(1).
+//
+// The trips may come in several files, read as one, each a CSV file
+// or a trip archive (see archive.h).  A trip whose
+// trip_id was already seen (in the same or another file) is dropped;
+// returns the # of trips dropped that way.
+//
+// With numThreads > 1 each file is split into line-aligned chunks (an
+// archive into its blocks), handed out to numThreads workers that count them into private
+// TripCounters; the counters are merged and inserted into the graph
+// once.  The resulting graph is the same as the one built by the serial
+// path.
+//
+// Either way, the trips are also counted per route and start time bucket
+// into buckets.
+//
+int ProcessTrips(const vector<string>& filenames, Graph& G, StationIndex& index, int numThreads,
+	TimeBucketCounter& buckets)
+{
+	string_view line;			// input line
+	TripIDSet   seen;			// trip ids so far
+	int         duplicates = 0;	// # of trips dropped as seen before
+
+	// verify if the files were mapped succesfully
+	TripFiles files;
+	if (!files.Open(filenames))	// failed to open:
+		return 0;
+
+	// parallel ingestion
+	if (numThreads > 1) {
+		// line-aligned chunks, handed out to the workers in turn; the
+		// files need not be the same size
+		vector<TripFiles::Chunk> chunks = files.Split(numThreads);
+		atomic<int>              next(0);
+
+		// count the chunks in the workers, each into its own counters
+		vector<TripCounter>       counters(numThreads);
+		vector<TimeBucketCounter> bucketCounters(numThreads);
+		vector<int>               dropped(numThreads, 0);
+		vector<thread>            workers;
+		for (int t = 0; t < numThreads; t++) {
+			workers.push_back(thread([&, t]() {
+				for (int c = next++; c < (int)chunks.size(); c = next++) {
+					if (chunks[c].Archive != nullptr)
+						dropped[t] += CountArchiveBlock(*chunks[c].Archive, chunks[c].Block, index, counters[t],
+							bucketCounters[t], seen);
+					else
+						dropped[t] += CountTripsChunk(chunks[c].Begin, chunks[c].End, index, counters[t],
+							bucketCounters[t], seen);
+				}
+			}));
+		}
+		for (thread& w : workers)
+			w.join();
+
+		// reduce into the first counter and bulk-insert
+		STAT_TIMER(insertTimer, Stat::TripsInsert);
+
+		for (int t = 1; t < numThreads; t++)
+			counters[0].Merge(counters[t]);
+		for (int t = 0; t < numThreads; t++)
+			buckets.Merge(bucketCounters[t]);
+
+		counters[0].InsertInto(G);
+
+		STAT_ITEMS(insertTimer, G.GetNumEdges());
+
+		for (int t = 0; t < numThreads; t++)
+			duplicates += dropped[t];
+		return duplicates;
+	}
+
+	// add new edge or update existing edge for a trip
+	auto addTrip = [&](int fromV, int toV, int bucket) {
+		STAT_TIMER(insertTimer, Stat::TripsInsert);
+
+		// check if Edge exist and insert or update weight
+		if (!G.EdgeExist(fromV, toV))
+			G.AddEdge(fromV, toV, 1);			// add new edge
+		else
+			G.UpdateWeight(fromV, toV, 1);		// update edge weight ( add 1 )		
+
+		// count the trip in its time bucket
+		if (bucket != -1)
+			buckets.Add(fromV, toV, bucket, 1);
+	};
+
+	// each file in turn, a single chunk per file (an archive's blocks
+	// in turn)
+	for (TripFiles::Chunk& chunk : files.Split(1)) {
+		if (chunk.Archive != nullptr) {
+			TripArchive::Rows rows;
+			if (!chunk.Archive->Decode(chunk.Block, rows, false))
+				continue;
+
+			vector<int> vertexOf = chunk.Archive->StationVertices(index);
+
+			for (size_t i = 0; i < rows.Flags.size(); i++) {
+				if ((rows.Flags[i] & TripArchive::HasTripID) && !seen.Claim(rows.TripIDs[i])) {
+					duplicates++;
+					continue;
+				}
+
+				int fromV = vertexOf[rows.From[i]];
+				int toV = vertexOf[rows.To[i]];
+
+				if (fromV != -1 && toV != -1)
+					addTrip(fromV, toV, rows.Buckets[i]);
+			}
+			continue;
+		}
+
+		CsvScanner input(chunk.Begin, chunk.End - chunk.Begin);
+
+		while (input.NextLine(line))	// for each line of input:
+		{
+			// format:
+			//   trip_id,starttime,stoptime,bikeid,tripduration,from_station_id,from_station_name,to_station_id,to_station_name,usertype,gender,birthyear
+			//   10426561,6/30/2016 23:35,7/1/2016 0:02,5229,1620,329,Lake Shore Dr & Diversey Pkwy,307,Southport Ave & Clybourn Ave,Subscriber,Male,1968
+			//
+			string_view idField, startField, fromField, toField;
+			int tripID, fromID, toID, fromPos, toPos, bucket;
+
+			{
+				STAT_TIMER(parseTimer, Stat::TripsParse);
+
+				//
+				// jump straight to trip_id, starttime, from_station_id and
+				// to_station_id, skipping blank or malformed lines:
+				//
+				if (!CsvScanner::Fields(line, 0, idField, 1, startField)
+					|| !CsvScanner::Fields(line, 5, fromField, 7, toField)
+					|| !CsvScanner::ParseInt(fromField, fromID)
+					|| !CsvScanner::ParseInt(toField, toID))
+					continue;
+
+				// skip a trip seen before, e.g. in the previous file
+				if (CsvScanner::ParseInt(idField, tripID) && !seen.Claim(tripID)) {
+					duplicates++;
+					continue;
+				}
+
+				//
+				// NOTE: don't trust the names in the trips file, not always accurate.  Trust the 
+				// from and to station ids, and then lookup in our vector of stations:
+				//
+
+				// find the stations by their id's
+				fromPos = index.Find(fromID);
+				toPos = index.Find(toID);
+
+				// time bucket of the trip
+				bucket = ParseTimeBucket(startField);
+			}
+
+			// skip trips from / to unknown stations
+			if (fromPos == -1 || toPos == -1)
+				continue;
+
+			// grab the vertices of the stations
+			int fromV = index.VertexOf(fromPos);
+			int toV = index.VertexOf(toPos);
+
+			if (fromV == -1 || toV == -1)
+				continue;
+
+			addTrip(fromV, toV, bucket);
+		}
+	}
+
+	return duplicates;
+}
+
+
+//
+// counts the trips in [begin, end), which must start at the beginning
+// of a line, into the given counters by vertex #, skipping the trips
+// whose trip_id is already in seen; returns the # skipped that way
+//
+int CountTripsChunk(const char *begin, const char *end, StationIndex& index, TripCounter& counter,
+	TimeBucketCounter& buckets, TripIDSet& seen)
+{
+	CsvScanner  input(begin, end - begin);
+	string_view line;
+	int         duplicates = 0;
+
+	while (input.NextLine(line))
+	{
+		STAT_TIMER(parseTimer, Stat::TripsParse);
+
+		string_view idField, startField, fromField, toField;
+		int tripID, fromID, toID;
+
+		// trip_id, starttime, from_station_id and to_station_id, as in
+		// ProcessTrips
+		if (!CsvScanner::Fields(line, 0, idField, 1, startField)
+			|| !CsvScanner::Fields(line, 5, fromField, 7, toField)
+			|| !CsvScanner::ParseInt(fromField, fromID)
+			|| !CsvScanner::ParseInt(toField, toID))
+			continue;
+
+		if (CsvScanner::ParseInt(idField, tripID) && !seen.Claim(tripID)) {
+			duplicates++;
+			continue;
+		}
+
+		// vertices of the stations, skip unknown stations
+		int fromV = index.VertexOf(index.Find(fromID));
+		int toV = index.VertexOf(index.Find(toID));
+
+		if (fromV == -1 || toV == -1)
+			continue;
+
+		counter.Add(fromV, toV, 1);
+
+		int bucket = ParseTimeBucket(startField);
+		if (bucket != -1)
+			buckets.Add(fromV, toV, bucket, 1);
+	}
+
+	return duplicates;
+}
+
+
+//
+// counts the trips of block # block of the archive into the given
+// counters, as CountTripsChunk does for lines; returns the # of trips
+// skipped as seen before.  Only the columns the graph needs are
+// decoded, and each station code is looked up once.
+//
+int CountArchiveBlock(TripArchive& archive, int block, StationIndex& index, TripCounter& counter,
+	TimeBucketCounter& buckets, TripIDSet& seen)
+{
+	TripArchive::Rows rows;
+	int               duplicates = 0;
+
+	if (!archive.Decode(block, rows, false))
+		return 0;
+
+	vector<int> vertexOf = archive.StationVertices(index);
+
+	for (size_t i = 0; i < rows.Flags.size(); i++) {
+		if ((rows.Flags[i] & TripArchive::HasTripID) && !seen.Claim(rows.TripIDs[i])) {
+			duplicates++;
+			continue;
+		}
+
+		int fromV = vertexOf[rows.From[i]];
+		int toV = vertexOf[rows.To[i]];
+
+		if (fromV == -1 || toV == -1)
+			continue;
+
+		counter.Add(fromV, toV, 1);
+
+		if (rows.Buckets[i] != -1)
+			buckets.Add(fromV, toV, rows.Buckets[i], 1);
+	}
+
+	return duplicates;
+}
+
+
+//
+// Loads the graph, the stations and the time buckets from the snapshot of
+// the given files, if there is an up-to-date one; otherwise builds them
+// from the files and, if saveSnapshot, saves a snapshot for next time.
+// Snapshots are only kept if DIVVY_SNAPSHOT_DIR names a directory for
+// them, so the input files' directory is never written to.  The snapshot is named after the
+// first trips file: "trips.csv.snap" for a single file,
+// "trips.csv+3.snap" if 3 more files follow it.
+//
+void LoadGraph(Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TimeBuckets& buckets,
+	string stationsFilename, const vector<string>& tripsFilenames, bool saveSnapshot)
+{
+	if (tripsFilenames.empty())
+		return;
+
+	const char *snapshotDir = getenv("DIVVY_SNAPSHOT_DIR");
+	string      snapshotFilename;
+
+	if (snapshotDir != nullptr && *snapshotDir != '\0') {
+		string name = filesystem::path(tripsFilenames[0]).filename().string();
+		if (tripsFilenames.size() > 1)
+			name += "+" + to_string(tripsFilenames.size() - 1);
+		name += ".snap";
+
+		snapshotFilename = (filesystem::path(snapshotDir) / name).string();
+		if (LoadSnapshot(snapshotFilename, DivvyGraph, stations, index, buckets, stationsFilename, tripsFilenames))
+			return;
+	}
+
+	TimeBucketCounter bucketCounter;
+
+	// read in stations into the graph Vertices and into Vector of stations
+	stations = InputStations(DivvyGraph, stationsFilename, index);
+	// build the adjacency list with edges, one ingest worker per core
+	int numThreads = (int)thread::hardware_concurrency();
+	ProcessTrips(tripsFilenames, DivvyGraph, index, numThreads, bucketCounter);
+	// graph is read-only from now on, compact it for the queries
+	DivvyGraph.Freeze();
+	// lay the trip time buckets out along the frozen edges
+	buckets.Build(DivvyGraph, bucketCounter);
+
+	if (saveSnapshot && !snapshotFilename.empty())
+		SaveSnapshot(snapshotFilename, DivvyGraph, stations, buckets, stationsFilename, tripsFilenames);
+}
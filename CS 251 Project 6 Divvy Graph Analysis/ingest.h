@@ -0,0 +1,43 @@
+//
+// ingest.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "graph.h"
+#include "station.h"
+#include "timebuckets.h"
+#include "tripcounter.h"
+#include "tripfiles.h"
+
+using namespace std;
+
+
+//
+// Reading the stations and trips files into the graph.  LoadGraph is the
+// usual entry point; the steps are public for the benchmarks.
+//
+
+
+// function prototypes
+int CountRecords(string filename);
+vector<Station> InputStations(Graph& G, string filename, StationIndex& index);
+int ProcessTrips(const vector<string>& filenames, Graph& G, StationIndex& index, int numThreads,
+	TimeBucketCounter& buckets);
+int CountTripsChunk(const char *begin, const char *end, StationIndex& index, TripCounter& counter,
+	TimeBucketCounter& buckets, TripIDSet& seen);
+int CountArchiveBlock(TripArchive& archive, int block, StationIndex& index, TripCounter& counter,
+	TimeBucketCounter& buckets, TripIDSet& seen);
+void LoadGraph(Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TimeBuckets& buckets,
+	string stationsFilename, const vector<string>& tripsFilenames, bool saveSnapshot);
@@ -12,297 +12,250 @@
 
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <string>
-#include <set>
 #include <vector>
+#include <thread>
 #include <algorithm>
+#include <cstdlib>
 
+#include "archive.h"
 #include "graph.h"
+#include "ingest.h"
+#include "odmatrix.h"
+#include "path.h"
+#include "queries.h"
+#include "server.h"
+#include "spatial.h"
+#include "station.h"
+#include "stats.h"
+#include "timebuckets.h"
+#include "tripfiles.h"
+#include "tripstore.h"
 
 using namespace std;
 
 #define _CRT_SECURE_NO_WARNINGS  // ignore C-related security warnings in Visual Studio
 
 
-//
-// Defines a Divvy Station:
-//
-class Station
-{
-public:
-	string Name;
-	int    ID;
-	double Latitude;
-	double Longitude;
-	int    Capacity;
-
-	// constructor
-	Station(string name, int id, double latitude, double longitude, int capacity)
-	{
-		Name = name;
-		ID = id;
-		Latitude = latitude;
-		Longitude = longitude;
-		Capacity = capacity;
-	}
-
-	// getter for station ID
-	int GetID() {
-		return this->ID;
-	}
-
-};
-
-
 // function prototypes
 string getFileName();
-vector<Station> InputStations(Graph& G, string filename);
-void ProcessTrips(string filename, Graph& G, vector<Station>& stations);
-void ShowTrips(Graph& DivvyGraph, vector<Station>& stations, int fromID, int toID);
-void ShowInfo(Graph& DivvyGraph, vector<Station>& stations, int userVal);
-Station FindStation(int id, vector<Station>& stations);
-int FindIDByName(string name, vector<Station>& stations);
-bool StationExist(int id, vector<Station>& stations);
-string GetStationName(int id, vector<Station>& stations);
-void BFS(Graph& DivvyGraph, vector<Station>& stations, int fromID);
+vector<string> getTripFileNames(string spec);
+bool FileExists(string filename);
+void SaveStats();
 
 
 
 
 // main
-int main()
+//
+// Interactive by default: the filenames and then the commands are read
+// from the keyboard.  Given the filenames as arguments, runs in batch
+// mode instead:
+//
+//   divvy stations.csv trips.csv [queries.txt | -] [threads]
+//
+// where the queries come from the file, or from stdin if it is "-" or
+// missing.  Either way, if DIVVY_STATS_FILE is set the statistics are
+// written to that file as JSON at the end (builds with DIVVY_STATS),
+// and the od command writes its matrices to the directory named by
+// DIVVY_EXPORT_DIR, or the current one.  If DIVVY_SNAPSHOT_DIR is set,
+// the graph is kept there as a snapshot for the next run (see
+// LoadGraph()); otherwise nothing is written next to the input files.
+//
+// In every mode the trips may be a comma-separated list of files, or a
+// pattern such as "Divvy_Trips_*.csv" (quoted, so the shell leaves it
+// alone); see ExpandTripFiles().
+//
+// The trips files can also be converted, once, into a compressed trip
+// archive that then stands in for them (see archive.h):
+//
+//   divvy --archive trips.csv trips.dva
+//
+// Or they can be served to several clients at once (see server.h),
+// until a client sends shutdown, and queried from another shell:
+//
+//   divvy --serve stations.csv trips.csv address [threads]
+//   divvy --client address
+//
+// where the address is a socket path or a localhost port.
+//
+int main(int argc, char *argv[])
 {
-	int    N = 1000;			// number of vertices
+	int    N = 1000;			// number of vertices, at least
 	Graph  DivvyGraph(N);		// declare the graph
 
-	cout << "** Divvy Graph Analysis **" << endl;
+	StationIndex    index;
+	vector<Station> stations;
+	TimeBuckets     buckets;
+	TripStore       trips;			// every trip field, read on demand
+	ODMatrix        od;				// dense trip counts, built on demand
 
-	// get filenames
-	string stationsFilename = getFileName();
-	string tripsFilename = getFileName();
+	// a mode given the wrong # of arguments
+	string mode = (argc >= 2) ? argv[1] : "";
+	string usage;
 
-	// read in stations into the graph Vertices and into Vector of stations
-	vector<Station> stations = InputStations(DivvyGraph, stationsFilename);
-	// build the adjacency list with edges
-	ProcessTrips(tripsFilename, DivvyGraph, stations);
+	if (mode == "--archive" && argc != 4)
+		usage = "--archive trips.csv trips.dva";
+	else if (mode == "--serve" && argc != 5 && argc != 6)
+		usage = "--serve stations.csv trips.csv address [threads]";
+	else if (mode == "--client" && argc != 3)
+		usage = "--client address";
 
-	// display graph stats
-	cout << ">> Graph:" << endl;
-	cout << "   # of vertices: " << DivvyGraph.GetNumVertices() << endl;
-	cout << "   # of edges:    " << DivvyGraph.GetNumEdges() << endl;
-	cout << ">> Ready:" << endl;
-	
+	if (!usage.empty())
+	{
+		cerr << "**Error: usage is 'divvy " << usage << "'" << endl << endl;
+		return 1;
+	}
 
-	string cmd;					// user command
-	int    fromID, toID;		// IDs for source and destination stations
+	// archive mode, the trips files into an archive
+	if (argc == 4 && string(argv[1]) == "--archive")
+	{
+		vector<string> tripsFilenames = getTripFileNames(argv[2]);
+		long long      numTrips;
+		int            duplicates;
 
-	cout << ">> ";
-	cin >> cmd;					// get the command
+		if (tripsFilenames.empty())
+			return 1;
 
-	while (cmd != "exit")
-	{
-		// show info about station choosen by user
-		if (cmd == "info")
+		if (!WriteArchive(tripsFilenames, argv[3], (int)thread::hardware_concurrency(), numTrips, duplicates))
 		{
-			cin >> fromID;
-
-			ShowInfo(DivvyGraph, stations, fromID);
+			cerr << "**Error: unable to write the archive '" << argv[3] << "'" << endl << endl;
+			return 1;
 		}
 
-		// show trips info from source to destination station choosen by user
-		else if (cmd == "trips")
-		{
-			cin >> fromID;
-			cin >> toID;
+		cout << ">> " << numTrips << " trips archived, " << duplicates << " duplicate trips dropped" << endl;
+		return 0;
+	}
 
-			ShowTrips(DivvyGraph, stations, fromID, toID);
-		}
+	// server mode, the queries come from the clients
+	if ((argc == 5 || argc == 6) && string(argv[1]) == "--serve")
+	{
+		string         stationsFilename = argv[2];
+		vector<string> tripsFilenames = getTripFileNames(argv[3]);
+		int            numThreads = (argc == 6) ? atoi(argv[5]) : (int)thread::hardware_concurrency();
 
-		// perform breath first search, display edges in order they were traversed
-		else if (cmd == "bfs")
-		{
-			cin >> fromID;
+		if (!FileExists(stationsFilename) || tripsFilenames.empty())
+			return 1;
 
-			BFS(DivvyGraph, stations, fromID);
-		}
+		shared_ptr<Dataset> data = make_shared<Dataset>();
+		if (!data->Load(stationsFilename, tripsFilenames))
+			return 1;
 
-		// diplay the whole graph
-		else if (cmd == "debug")
+		QueryServer server(stationsFilename, data, numThreads);
+		if (!server.Listen(argv[4]))
 		{
-			DivvyGraph.PrintGraph("Divvy Graph");
+			cerr << "**Error: unable to listen on '" << argv[4] << "'" << endl << endl;
+			return 1;
 		}
 
-		// invalid command
-		else
-		{
-			cout << "**Invalid command, try again..." << endl;
-		}
+		cout << ">> Serving " << argv[4] << ": " << data->DivvyGraph.GetNumVertices() << " vertices, "
+			<< data->DivvyGraph.GetNumEdges() << " edges" << endl;
+		data.reset();		// the server holds it from now on
 
-		// read in next command
-		cout << ">> ";
-		cin >> cmd;
+		server.Run();
+
+		SaveStats();
+		cout << "**Done**" << endl;
+		return 0;
 	}
 
-	cout << "**Done**" << endl;
-	return 0;
-}	// end of main
+	// client mode, the commands from stdin go to a server
+	if (argc == 3 && string(argv[1]) == "--client")
+		return RunClient(argv[2], cin, cout);
 
+	// batch mode, nothing but the query output is written
+	if (argc >= 3)
+	{
+		string         stationsFilename = argv[1];
+		vector<string> tripsFilenames = getTripFileNames(argv[2]);
+		string         queriesFilename = (argc >= 4) ? argv[3] : "-";
+		int            numThreads = (argc >= 5) ? atoi(argv[4]) : (int)thread::hardware_concurrency();
 
+		if (!FileExists(stationsFilename) || tripsFilenames.empty()
+			|| (queriesFilename != "-" && !FileExists(queriesFilename)))
+			return 1;
 
+		// room for every station, even in larger files
+		DivvyGraph = Graph(max(N, CountRecords(stationsFilename)));
+		LoadGraph(DivvyGraph, stations, index, buckets, stationsFilename, tripsFilenames, true);
+		trips.SetSource(tripsFilenames);
 
-// ----------------------------------------------------------------------------
-// function definitions
-// ----------------------------------------------------------------------------
+		SpatialIndex spatial;
+		spatial.Build(stations);
 
+		if (queriesFilename == "-") {
+			RunBatch(cin, DivvyGraph, stations, index, buckets, trips, od, spatial, numThreads);
+		}
+		else {
+			ifstream queries(queriesFilename);
+			RunBatch(queries, DivvyGraph, stations, index, buckets, trips, od, spatial, numThreads);
+		}
 
-//
-// Inputs the stations from the given file, adding each station name as a
-// vertex to the graph, and storing a new Station object into the vector.
-// The graph is passed by reference --- note the & --- so that the changes
-// made by the function are returned back.  The vector of Station objects is
-// returned by the function.
-//
-vector<Station> InputStations(Graph& G, string filename)
-{
-	string line;			// input line
-	vector<Station> V;		// stations Vector
+		SaveStats();
+		return 0;
+	}
 
-	// verify if file was succesfully opened
-	ifstream input(filename);	
-	if (!input.good())			// failed to open:
-		return V;
+	cout << "** Divvy Graph Analysis **" << endl;
 
-	getline(input, line);		// skip first line: column headers
-	getline(input, line);		// first line of real data
+	// get filenames
+	string stationsFilename = getFileName();
+	if (stationsFilename.empty())
+		return 1;
+	string tripsLine;
+	getline(cin, tripsLine);
+	vector<string> tripsFilenames = getTripFileNames(tripsLine);
+	if (tripsFilenames.empty())
+		return 1;
+
+	// room for every station, even in larger files
+	DivvyGraph = Graph(max(N, CountRecords(stationsFilename)));
+	LoadGraph(DivvyGraph, stations, index, buckets, stationsFilename, tripsFilenames, true);
+	trips.SetSource(tripsFilenames);
+
+	// grid over the station coordinates for the near / within queries
+	SpatialIndex spatial;
+	spatial.Build(stations);
 
-	while (!input.eof())		// for each line of input:
-	{
-		stringstream  ss(line);
-
-		// format:
-		//   id,name,latitude,longitude,dpcapacity,online_date
-		//   456,2112 W Peterson Ave,41.991178,-87.683593,15,5/12/2015
-		//   101,63rd St Beach,41.78101637,-87.57611976,23,4/20/2015
-		//
-		string  stationID, name, latitude, longitude, capacity;
-
-		//
-		// parse the line:
-		//
-		getline(ss, stationID, ',');
-		getline(ss, name, ',');
-		getline(ss, latitude, ',');
-		getline(ss, longitude, ',');
-		getline(ss, capacity, ',');
-
-		//
-		// Create a new station object:
-		//
-		Station S(name,
-			stoi(stationID),
-			stod(latitude),
-			stod(longitude),
-			stoi(capacity));
-
-
-		// add station object to vector
-		V.push_back(S);
-
-		// add vertex to graph
-		G.AddVertex(name);
-
-		// read in next line
-		getline(input, line);
-	}
+	// display graph stats
+	cout << ">> Graph:" << endl;
+	cout << "   # of vertices: " << DivvyGraph.GetNumVertices() << endl;
+	cout << "   # of edges:    " << DivvyGraph.GetNumEdges() << endl;
+	cout << ">> Ready:" << endl;
 
-	// sort the vector
-	sort(V.begin(), V.end(),
-		[](Station s1, Station s2) {
+	// shortest path engine, reused by every path query
+	PathEngine paths(DivvyGraph, stations, index);
+	
 
-		if (s1.GetID() < s2.GetID()) {
-			return true;
-		}
-		else
-			return false;
-	});
+	string line;				// user command, with its arguments
 
-	return V;		// return the vector
-}
+	// one command per line, until exit or the end of the input; the
+	// output is flushed only when the next command is read
+	cout << ">> ";
+	while (getline(cin, line))
+	{
+		// skip blank lines
+		if (line.find_first_not_of(" \t\r") == string::npos)
+			continue;
 
+		if (!RunQuery(cout, line, DivvyGraph, stations, index, buckets, trips, od, paths, spatial))
+			break;
 
-//
-// Inputs the trips, adding / updating the edges in the graph.  The graph is
-// passed by reference --- note the & --- so that the changes made by the 
-// function are returned back.  The vector of stations is needed so that 
-// station ids can be mapped to names; it is passed by reference only for 
-// efficiency (so that a copy is not made).
-//
-void ProcessTrips(string filename, Graph& G, vector<Station>& stations)
-{
-	string line;				// input line
+		// read in next command
+		cout << ">> ";
+	}
 
-	// verify if file was opened succesfully
-	ifstream input(filename);
-	if (!input.good())			// failed to open:
-		return;
+	SaveStats();
 
-	getline(input, line);		// skip first line: column headers
-	getline(input, line);		// first line of real data
+	cout << "**Done**" << endl;
+	return 0;
+}	// end of main
 
-	while (!input.eof())		// for each line of input:
-	{
-		stringstream  ss(line);
-
-		// format:
-		//   trip_id,starttime,stoptime,bikeid,tripduration,from_station_id,from_station_name,to_station_id,to_station_name,usertype,gender,birthyear
-		//   10426561,6/30/2016 23:35,7/1/2016 0:02,5229,1620,329,Lake Shore Dr & Diversey Pkwy,307,Southport Ave & Clybourn Ave,Subscriber,Male,1968
-		//
-		string  tripID, fromID, toID, skip;
-
-		//
-		// parse the input line:
-		//
-		getline(ss, tripID, ',');
-		getline(ss, skip, ',');
-		getline(ss, skip, ',');
-		getline(ss, skip, ',');
-		getline(ss, skip, ',');
-		getline(ss, fromID, ',');
-		getline(ss, skip, ',');
-		getline(ss, toID, ',');
-		getline(ss, skip, ',');
-
-		//
-		// NOTE: don't trust the names in the trips file, not always accurate.  Trust the 
-		// from and to station ids, and then lookup in our vector of stations:
-		//
-
-		// add new edge or update existing edge for this trip
-
-		// find and store the names of the stations and id's as int
-		int fromInt = stoi(fromID);
-		int toInt = stoi(toID);
-		string fromName, toName;
-
-		// grab the names for the stations
-		for (auto s : stations) {
-			if (s.ID == fromInt)
-				fromName = s.Name;
-			if (s.ID == toInt)
-				toName = s.Name;
-		}
 
-		// check if Edge exist and insert or update weight
-		if (!G.EdgeExist(fromName, toName))
-			G.AddEdge(fromName, toName, 1);			// add new edge
-		else
-			G.UpdateWeight(fromName, toName, 1);	// update edge weight ( add 1 )		
 
-		// read in next line
-		getline(input, line);
-	}
-}
+
+// ----------------------------------------------------------------------------
+// function definitions
+// ----------------------------------------------------------------------------
 
 
 //
@@ -310,7 +263,7 @@ void ProcessTrips(string filename, Graph& G, vector<Station>& stations)
 //
 // Inputs a filename from the keyboard, checks that the file can be
 // opened, and returns the filename if so.  If the file cannot be 
-// opened, an error message is output and the program is exited.
+// opened, an error message is output and an empty filename is returned.
 //
 string getFileName()
 {
@@ -320,165 +273,67 @@ string getFileName()
 	getline(cin, filename);
 
 	// make sure filename exists and can be opened:
-	ifstream file(filename);
-	if (!file.good())
-	{
-		cout << "**Error: unable to open '" << filename << "'" << endl << endl;
-		std::terminate();
-	}
+	if (!FileExists(filename))
+		return "";
 
 	return filename;	// return filename
 }
 
 
 //
-// find station by given id and return the station object,
-// station always exists if this function is called
-//
-Station FindStation(int id, vector<Station>& stations)
-{
-	// traverse the station vector and return station object when found
-	for (auto s : stations) {
-		if (s.ID == id)
-			return s;		// return station object
-	}
-}
-
-
+// getTripFileNames:
 //
-// find station ID by given name, 
-// returns station ID or -1 if not found
+// Expands the trips files the user gave, a list or a pattern (see
+// ExpandTripFiles()), and checks that each can be opened.  Returns
+// the filenames if so; otherwise, or if nothing matched, an error
+// message is output and an empty vector is returned.
 //
-int FindIDByName(string name, vector<Station>& stations) 
+vector<string> getTripFileNames(string spec)
 {
-	// traverse the station vector and return station ID when found
-	for (auto s : stations) {
-		if (s.Name == name)
-			return s.ID;		// found
-	}
-
-	return 0;					// not found
-}
+	vector<string> filenames = ExpandTripFiles(spec);
 
-
-//
-// verifies if station exists in vector of Stations,
-// returns true if station exist, false is returned otherwise 
-//
-bool StationExist(int id, vector<Station>& stations) 
-{
-	// traverse the station vector and return true or false
-	for (auto s : stations) {
-		if (s.ID == id)
-			return true;	// exist
+	if (filenames.empty()) {
+		cerr << "**Error: no trips files match '" << spec << "'" << endl << endl;
+		return filenames;
 	}
 
-	return false;			// does not exist
-}
-
-
-//
-// collects the info about the station choosen by user,
-// function uses other functions for collecting informations, 
-// then displays them to the user 
-// 
-void ShowInfo(Graph& DivvyGraph, vector<Station>& stations, int userVal)
-{
-
-	// verify if station exist
-	if (!(StationExist(userVal, stations))) {
-		cout << "** No such station..." << endl;
-		return;
+	// make sure every file exists and can be opened:
+	for (string& filename : filenames) {
+		if (!FileExists(filename))
+			return vector<string>();
 	}
 
-	// find station
-	Station result = FindStation(userVal, stations);
-
-	// find neighbors and store them in set of strings
-	set<string> AdjacentStations = DivvyGraph.GetNeighbors(result.Name);
-
-	// display results
-	cout << result.Name << endl;
-	cout << "(" << result.Latitude << "," << result.Longitude << ")" << endl;
-	cout << "Capacity: " << result.Capacity << endl;
-	cout << "# of destination stations: " << AdjacentStations.size() << endl;
-	cout << "# of trips to those stations: " << DivvyGraph.CountTrips(result.Name) << endl;
-	cout << "Station: trips" << endl;
-	// display info about trips
-	for (auto s : AdjacentStations) {
-		cout << "   " << s << " ";				// name
-		int destID = FindIDByName(s, stations);	// find destination ID
-		// find and display the edge
-		cout << "(" << destID << "): " << (DivvyGraph.GetEdgeWeight(result.Name, s)) << endl;
-	}
+	return filenames;
 }
 
 
 //
-// returns the name of the station based on given ID if station is found,
-// otherwise NULL is returned
+// returns true if the given file can be opened, otherwise tells the
+// user and returns false
 //
-string GetStationName(int id, vector<Station>& stations) 
+bool FileExists(string filename)
 {
-	// linear search, returns the name if found, null otherwise
-	for (auto s : stations) {
-		if (s.ID == id)
-			return s.Name;	// found
-	}
-	return NULL;			// not found
-}
-
-
-//
-// by using other functions grabs the info about trip for source station
-// to destination station and the displays the station names
-// along with the number of trips from source station to destination station
-//
-void ShowTrips(Graph& DivvyGraph, vector<Station>& stations, int fromID, int toID) 
-{
-	// verify if both stations exists
-	if (!(StationExist(fromID, stations)) || !(StationExist(toID, stations))) {
-		cout << "** One of those stations doesn't exist..." << endl;
-		return;
+	ifstream file(filename);
+	if (!file.good())
+	{
+		cerr << "**Error: unable to open '" << filename << "'" << endl << endl;
+		return false;
 	}
 
-	// grab the names for fromID and toID
-	string fromName = GetStationName(fromID, stations);
-	string toName = GetStationName(toID, stations);
-
-	// display names
-	cout << fromName << " -> " << toName << endl;
-	// display num,ber of trips from station A to station B
-	cout << "# of trips: " << DivvyGraph.GetEdgeWeight(fromName, toName) << endl;
+	return true;
 }
 
 
 //
-// BFS
-// calls the BFS recursive function which returns vector with station
-// names in order they were traversed, then finction finds the ID for 
-// every name and diplay the IDs
+// SaveStats:
 //
-void BFS(Graph& DivvyGraph, vector<Station>& stations, int fromID) 
+// Writes the statistics to the file named by the DIVVY_STATS_FILE
+// environment variable, if set.
+//
+void SaveStats()
 {
+	const char *filename = getenv("DIVVY_STATS_FILE");
 
-	// verify if station exist
-	if (!(StationExist(fromID, stations))) {
-		cout << "** No such station..." << endl;
-		return;
-	}
-
-	// grab the name of fromID
-	string fromName = GetStationName(fromID, stations);
-	// grab the index in Vertices 
-	vector<string> BFSVisited = DivvyGraph.BFS(fromName);
-
-	cout << "# of stations: " << BFSVisited.size() << endl;
-
-	// for each name find ID and display
-	for (auto s : BFSVisited) {
-		cout << FindIDByName(s, stations) << ", ";
-	}
-
-	cout << "#" << endl;
-}
\ No newline at end of file
+	if (filename != nullptr && *filename != '\0' && !DumpStats(filename))
+		cerr << "**Error: unable to write statistics to '" << filename << "'" << endl;
+}
@@ -0,0 +1,313 @@
+//
+// odmatrix.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#include <fstream>
+#include <charconv>
+#include <cstring>
+
+#include "odmatrix.h"
+#include "stats.h"
+
+// SSE2 is part of every x86-64 target, so this holds wherever it matters
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DIVVY_SSE2
+#endif
+
+using namespace std;
+
+
+//
+// returns the sum of the n counts at p
+//
+static uint32_t SumRow(const uint32_t *p, int n)
+{
+	int      i = 0;
+	uint32_t sum = 0;
+
+#ifdef DIVVY_SSE2
+	__m128i acc0 = _mm_setzero_si128();
+	__m128i acc1 = _mm_setzero_si128();
+
+	for (; i + 8 <= n; i += 8) {
+		acc0 = _mm_add_epi32(acc0, _mm_loadu_si128((const __m128i *)(p + i)));
+		acc1 = _mm_add_epi32(acc1, _mm_loadu_si128((const __m128i *)(p + i + 4)));
+	}
+
+	// fold the 4 lanes into one
+	acc0 = _mm_add_epi32(acc0, acc1);
+	acc0 = _mm_add_epi32(acc0, _mm_shuffle_epi32(acc0, _MM_SHUFFLE(1, 0, 3, 2)));
+	acc0 = _mm_add_epi32(acc0, _mm_shuffle_epi32(acc0, _MM_SHUFFLE(2, 3, 0, 1)));
+	sum = (uint32_t)_mm_cvtsi128_si32(acc0);
+#endif
+
+	for (; i < n; i++)
+		sum += p[i];
+
+	return sum;
+}
+
+
+//
+// adds the n counts at src to the n at dst
+//
+static void AddRow(uint32_t *dst, const uint32_t *src, int n)
+{
+	int i = 0;
+
+#ifdef DIVVY_SSE2
+	for (; i + 4 <= n; i += 4) {
+		__m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+		__m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_add_epi32(d, s));
+	}
+#endif
+
+	for (; i < n; i++)
+		dst[i] += src[i];
+}
+
+
+//
+// index in Cells of the cell (r, c), with tiles tiles per side
+//
+static inline size_t CellIndex(int tiles, int r, int c)
+{
+	const int T = ODMatrix::Tile;
+
+	return ((size_t)(r / T) * tiles + c / T) * T * T + (size_t)(r % T) * T + c % T;
+}
+
+
+//
+// default constructor: no matrix until built
+//
+ODMatrix::ODMatrix()
+	: N(0), Tiles(0), Built(false)
+{ }
+
+
+//
+// fills the matrix from the frozen graph's edges and sums up its rows
+// and columns; returns false, building nothing, if the graph is not
+// frozen or has more than MaxVertices vertices
+//
+bool ODMatrix::Build(Graph& G)
+{
+	STAT_TIMER(timer, Stat::ODMatrixBuild);
+
+	if (!G.IsFrozen() || G.GetNumVertices() > MaxVertices)
+		return false;
+
+	const int T = Tile;
+
+	this->N = G.GetNumVertices();
+	this->Tiles = (this->N + T - 1) / T;
+	this->Cells.assign((size_t)this->Tiles * this->Tiles * T * T, 0);
+
+	const vector<int>&                offsets = G.GetOffsets();
+	const vector<Graph::VertexType>&  dests = G.GetDests();
+	const vector<Graph::WeightType>&  weights = G.GetWeights();
+
+	for (int v = 0; v < this->N; v++) {
+		for (int e = offsets[v]; e < offsets[v + 1]; e++)
+			this->Cells[CellIndex(this->Tiles, v, dests[e])] = weights[e];
+	}
+
+	// a tile at a time: each of its rows adds to one row sum and to the
+	// column sums of the tile's columns, all within the tile
+	this->RowSums.assign((size_t)this->Tiles * T, 0);
+	this->ColSums.assign((size_t)this->Tiles * T, 0);
+
+	for (int tr = 0; tr < this->Tiles; tr++) {
+		for (int tc = 0; tc < this->Tiles; tc++) {
+			const uint32_t *tile = &this->Cells[((size_t)tr * this->Tiles + tc) * T * T];
+
+			for (int r = 0; r < T; r++) {
+				this->RowSums[tr * T + r] += SumRow(tile + r * T, T);
+				AddRow(&this->ColSums[tc * T], tile + r * T, T);
+			}
+		}
+	}
+
+	// drop the padding
+	this->RowSums.resize(this->N);
+	this->ColSums.resize(this->N);
+
+	STAT_ITEMS(timer, weights.size());
+	this->Built = true;
+	return true;
+}
+
+
+//
+// builds the matrix the first time it is called, by whichever thread
+// gets there first; returns false if the graph gets no matrix
+//
+bool ODMatrix::EnsureBuilt(Graph& G)
+{
+	call_once(this->BuildOnce, [&]() {
+		this->Build(G);
+	});
+
+	return this->Built;
+}
+
+
+//
+// true once built; safe while another thread is building it
+//
+bool ODMatrix::IsBuilt()
+{
+	return this->Built;
+}
+
+
+//
+// # of rows (= # of columns, = # of vertices)
+//
+int ODMatrix::GetSize()
+{
+	return this->N;
+}
+
+
+//
+// # of trips from vertex from to vertex to
+//
+uint32_t ODMatrix::Get(int from, int to)
+{
+	return this->Cells[CellIndex(this->Tiles, from, to)];
+}
+
+
+//
+// # of trips leaving each vertex, by vertex #
+//
+const vector<uint32_t>& ODMatrix::GetRowSums()
+{
+	return this->RowSums;
+}
+
+
+//
+// # of trips arriving at each vertex, by vertex #
+//
+const vector<uint32_t>& ODMatrix::GetColSums()
+{
+	return this->ColSums;
+}
+
+
+//
+// copies the cells of the given rows and columns (vertex #s) to block,
+// row-major: block[i * cols.size() + j] = Get(rows[i], cols[j])
+//
+void ODMatrix::Extract(const vector<int>& rows, const vector<int>& cols, vector<uint32_t>& block)
+{
+	size_t numCols = cols.size();
+
+	// a column's place within any row of tiles
+	vector<size_t> colOffsets(numCols);
+	for (size_t j = 0; j < numCols; j++)
+		colOffsets[j] = CellIndex(this->Tiles, 0, cols[j]);
+
+	block.resize(rows.size() * numCols);
+
+	for (size_t i = 0; i < rows.size(); i++) {
+		const uint32_t *row = &this->Cells[CellIndex(this->Tiles, rows[i], 0)];
+		uint32_t       *out = &block[i * numCols];
+
+		for (size_t j = 0; j < numCols; j++)
+			out[j] = row[colOffsets[j]];
+	}
+}
+
+
+//
+// row and column sums of a row-major numRows x numCols block
+//
+void ODMatrix::Sums(const vector<uint32_t>& block, int numRows, int numCols, vector<uint32_t>& rowSums,
+	vector<uint32_t>& colSums)
+{
+	rowSums.assign(numRows, 0);
+	colSums.assign(numCols, 0);
+
+	for (int i = 0; i < numRows; i++) {
+		const uint32_t *row = block.data() + (size_t)i * numCols;
+
+		rowSums[i] = SumRow(row, numCols);
+		AddRow(colSums.data(), row, numCols);
+	}
+}
+
+
+//
+// writes a square block as CSV: a header line of the station ids, then
+// a line per row, its station id and then its counts; returns false if
+// the file cannot be written
+//
+bool ODMatrix::SaveCSV(string filename, const vector<int>& ids, const vector<uint32_t>& block)
+{
+	ofstream output(filename, ios::trunc);
+	if (!output.good())
+		return false;
+
+	size_t k = ids.size();
+	string line;
+	char   digits[16];
+
+	line = "from\\to";
+	for (size_t j = 0; j < k; j++) {
+		line += ',';
+		line.append(digits, to_chars(digits, digits + sizeof(digits), ids[j]).ptr);
+	}
+	output << line << '\n';
+
+	for (size_t i = 0; i < k; i++) {
+		line.assign(digits, to_chars(digits, digits + sizeof(digits), ids[i]).ptr);
+
+		for (size_t j = 0; j < k; j++) {
+			line += ',';
+			line.append(digits, to_chars(digits, digits + sizeof(digits), block[i * k + j]).ptr);
+		}
+		output << line << '\n';
+	}
+
+	return output.good();
+}
+
+
+//
+// writes a square block in the binary format described in odmatrix.h;
+// returns false if the file cannot be written
+//
+bool ODMatrix::SaveBinary(string filename, const vector<int>& ids, const vector<uint32_t>& block)
+{
+	ofstream output(filename, ios::binary | ios::trunc);
+	if (!output.good())
+		return false;
+
+	ODMatrixHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.Magic, "DIVVYODM", 8);
+	header.Version = ODMatrixVersion;
+	header.Size = (uint32_t)ids.size();
+
+	vector<int32_t> stationIDs(ids.begin(), ids.end());
+
+	output.write((const char *)&header, sizeof(header));
+	output.write((const char *)stationIDs.data(), stationIDs.size() * sizeof(int32_t));
+	output.write((const char *)block.data(), block.size() * sizeof(uint32_t));
+
+	return output.good();
+}
@@ -0,0 +1,90 @@
+//
+// odmatrix.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+#include "graph.h"
+
+using namespace std;
+
+
+//
+// Binary export of an OD matrix (see ODMatrix::SaveBinary()), native
+// byte order:
+//   ODMatrixHeader
+//   int32_t  StationIDs[Size]			the rows, and the columns in the same order
+//   uint32_t Counts[Size * Size]		row-major: trips from row station to column station
+//
+const uint32_t ODMatrixVersion = 1;
+
+class ODMatrixHeader
+{
+public:
+	char     Magic[8];				// "DIVVYODM"
+	uint32_t Version;				// ODMatrixVersion
+	uint32_t Size;					// # of rows = # of columns
+};
+
+
+//
+// ODMatrix class
+//
+// The trip counts of the frozen graph as a dense origin-destination
+// matrix over the vertices, for pulling whole matrices (or the block of
+// a set of stations) at once rather than route by route.  The cells are
+// stored in Tile x Tile tiles, tile after tile, each row-major, so the
+// row and column sums run over one cache-resident tile at a time with
+// SIMD adds, and a block of a few stations touches few cache lines.
+// The matrix is padded with zeros to whole tiles.
+//
+// Optional: built by the first query needing it (EnsureBuilt()); at
+// most MaxVertices vertices, 256 MB of cells.
+//
+class ODMatrix
+{
+public:
+	static const int Tile = 64;				// cells per tile side
+	static const int MaxVertices = 8192;	// larger graphs get no matrix
+
+private:
+	int              N;				// # of vertices
+	int              Tiles;			// # of tiles per side
+	vector<uint32_t> Cells;			// the tiles, (row tile, column tile) row-major
+	vector<uint32_t> RowSums;		// trips leaving each vertex
+	vector<uint32_t> ColSums;		// trips arriving at each vertex
+	once_flag        BuildOnce;		// EnsureBuilt() builds once
+	atomic<bool>     Built;			// true once built, set last
+
+public:
+	ODMatrix();
+
+	// public function prototypes
+	bool Build(Graph& G);
+	bool EnsureBuilt(Graph& G);
+	bool IsBuilt();
+	int GetSize();
+	uint32_t Get(int from, int to);
+	const vector<uint32_t>& GetRowSums();
+	const vector<uint32_t>& GetColSums();
+	void Extract(const vector<int>& rows, const vector<int>& cols, vector<uint32_t>& block);
+
+	static void Sums(const vector<uint32_t>& block, int numRows, int numCols, vector<uint32_t>& rowSums,
+		vector<uint32_t>& colSums);
+	static bool SaveCSV(string filename, const vector<int>& ids, const vector<uint32_t>& block);
+	static bool SaveBinary(string filename, const vector<int>& ids, const vector<uint32_t>& block);
+};
@@ -0,0 +1,181 @@
+//
+// path.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#include <algorithm>
+
+#include "geo.h"
+#include "path.h"
+
+using namespace std;
+
+
+//
+// Constructor:
+//
+// Copies each vertex's coordinates out of its station and sizes the
+// working arrays for the graph.
+//
+PathEngine::PathEngine(Graph& G, vector<Station>& stations, StationIndex& index)
+	: G(G)
+{
+	this->NumVertices = G.GetNumVertices();
+	this->Latitude.assign(this->NumVertices, 0.0);
+	this->Longitude.assign(this->NumVertices, 0.0);
+
+	for (int v = 0; v < this->NumVertices; v++) {
+		int pos = index.FindByVertex(v);
+		if (pos != -1) {
+			this->Latitude[v] = stations[pos].Latitude;
+			this->Longitude[v] = stations[pos].Longitude;
+		}
+	}
+
+	this->Dist.assign(this->NumVertices, 0.0);
+	this->Parent.assign(this->NumVertices, -1);
+	this->Seen.assign(this->NumVertices, 0);
+	this->Done.assign(this->NumVertices, 0);
+	this->Stamp = 0;
+	this->Heap.reserve(this->NumVertices);
+	this->NumSettled = 0;
+}
+
+
+//
+// great-circle distance in meters between vertices u and v
+//
+double PathEngine::Distance(int u, int v)
+{
+	return Haversine(this->Latitude[u], this->Longitude[u], this->Latitude[v], this->Longitude[v]);
+}
+
+
+//
+// cost of the edge u -> v carrying weight trips
+//
+double PathEngine::EdgeCost(int u, int v, int weight, PathCost cost)
+{
+	switch (cost) {
+	case PathCost::Distance:
+		return this->Distance(u, v);
+	case PathCost::Popularity:
+		return 1.0 / max(weight, 1);
+	default:
+		return 1.0;
+	}
+}
+
+
+//
+// pushes v with the given key onto the heap
+//
+void PathEngine::HeapPush(double key, int v)
+{
+	this->Heap.push_back(HeapEntry{ key, v });
+	push_heap(this->Heap.begin(), this->Heap.end(),
+		[](const HeapEntry& a, const HeapEntry& b) { return a.Key > b.Key; });
+}
+
+
+//
+// pops the entry with the smallest key
+//
+PathEngine::HeapEntry PathEngine::HeapPop()
+{
+	pop_heap(this->Heap.begin(), this->Heap.end(),
+		[](const HeapEntry& a, const HeapEntry& b) { return a.Key > b.Key; });
+
+	HeapEntry top = this->Heap.back();
+	this->Heap.pop_back();
+	return top;
+}
+
+
+//
+// ShortestPath:
+//
+// Finds the cheapest path from vertex src to vertex dest under the
+// given cost.  On success fills path with the vertices from src to
+// dest, total with the path cost, and returns true; returns false if
+// dest is not reachable or either vertex does not exist.
+//
+bool PathEngine::ShortestPath(int src, int dest, PathCost cost, bool astar, vector<int>& path, double& total)
+{
+	path.clear();
+	total = 0.0;
+	this->NumSettled = 0;
+
+	if (!this->G.IsFrozen() || src < 0 || src >= this->NumVertices
+		|| dest < 0 || dest >= this->NumVertices)
+		return false;
+
+	// great-circle distance never overestimates the remaining distance
+	bool useHeuristic = astar && cost == PathCost::Distance;
+	auto heuristic = [&](int v) { return useHeuristic ? this->Distance(v, dest) : 0.0; };
+
+	const vector<int>& offsets = this->G.GetOffsets();
+	const vector<Graph::VertexType>& dests = this->G.GetDests();
+	const vector<Graph::WeightType>& weights = this->G.GetWeights();
+
+	// new query: every Dist / Parent / Done entry becomes stale
+	if (++this->Stamp == 0) {
+		fill(this->Seen.begin(), this->Seen.end(), 0);
+		fill(this->Done.begin(), this->Done.end(), 0);
+		this->Stamp = 1;
+	}
+	this->Heap.clear();
+
+	this->Dist[src] = 0.0;
+	this->Parent[src] = -1;
+	this->Seen[src] = this->Stamp;
+	this->HeapPush(heuristic(src), src);
+
+	while (!this->Heap.empty()) {
+		int u = this->HeapPop().Vertex;
+
+		// stale entry, u was settled through a cheaper path
+		if (this->Done[u] == this->Stamp)
+			continue;
+
+		this->Done[u] = this->Stamp;
+		this->NumSettled++;
+
+		if (u == dest)
+			break;
+
+		// relax the out-edges of u
+		for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+			int    v = dests[e];
+			double d = this->Dist[u] + this->EdgeCost(u, v, weights[e], cost);
+
+			if (this->Done[v] == this->Stamp)
+				continue;
+
+			if (this->Seen[v] != this->Stamp || d < this->Dist[v]) {
+				this->Seen[v] = this->Stamp;
+				this->Dist[v] = d;
+				this->Parent[v] = u;
+				this->HeapPush(d + heuristic(v), v);
+			}
+		}
+	}
+
+	if (this->Done[dest] != this->Stamp)
+		return false;			// not reachable
+
+	// walk the parents back from dest
+	for (int v = dest; v != -1; v = this->Parent[v])
+		path.push_back(v);
+	reverse(path.begin(), path.end());
+
+	total = this->Dist[dest];
+	return true;
+}
@@ -0,0 +1,80 @@
+//
+// path.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <vector>
+#include <string>
+
+#include "graph.h"
+#include "station.h"
+
+using namespace std;
+
+
+//
+// cost of following an edge
+//
+enum class PathCost
+{
+	Distance,						// great-circle meters between the stations
+	Popularity,						// 1 / # of trips on the edge
+	Hops							// 1 per edge
+};
+
+
+//
+// PathEngine class
+//
+// Weighted shortest paths over the frozen graph: Dijkstra with a
+// binary heap, or A* with great-circle distance to the target as the
+// heuristic (admissible for the Distance cost; the other costs fall
+// back to Dijkstra).  All working arrays are allocated once and reused,
+// entries are invalidated by bumping a stamp instead of clearing.
+//
+class PathEngine
+{
+private:
+
+	// HeapEntry class
+	class HeapEntry
+	{
+	public:
+		double Key;					// distance + heuristic
+		int    Vertex;
+	};
+
+	Graph             &G;			// graph being searched, must be frozen
+	int                NumVertices;	// # of vertices
+	vector<double>     Latitude;	// coordinates of each vertex
+	vector<double>     Longitude;
+	vector<double>     Dist;		// best known cost to each vertex
+	vector<int>        Parent;		// previous vertex on the best path
+	vector<unsigned>   Seen;		// Dist / Parent valid when == Stamp
+	vector<unsigned>   Done;		// vertex settled when == Stamp
+	unsigned           Stamp;		// current query #
+	vector<HeapEntry>  Heap;		// binary min-heap on Key
+
+	// private function prototypes
+	double EdgeCost(int u, int v, int weight, PathCost cost);
+	void HeapPush(double key, int v);
+	HeapEntry HeapPop();
+
+public:
+	int                NumSettled;	// # of vertices settled by the last query
+
+	PathEngine(Graph& G, vector<Station>& stations, StationIndex& index);
+
+	// public function prototypes
+	bool ShortestPath(int src, int dest, PathCost cost, bool astar, vector<int>& path, double& total);
+	double Distance(int u, int v);
+};
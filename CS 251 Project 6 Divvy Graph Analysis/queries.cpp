@@ -0,0 +1,1454 @@
+//
+// queries.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <set>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <cstdio>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+
+#include "bfs.h"
+#include "queries.h"
+#include "stats.h"
+
+using namespace std;
+
+
+
+//
+// RunQuery:
+//
+// Runs a single command line, e.g. "info 35", writing its output to
+// out.  Returns false for exit.  Only reads the graph and the indexes,
+// so different threads may run queries at once as long as each has its
+// own path engine.
+//
+bool RunQuery(ostream& out, string line, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index,
+	TimeBuckets& buckets, TripStore& trips, ODMatrix& od, PathEngine& paths, SpatialIndex& spatial)
+{
+	stringstream ss(line);
+	string       cmd;					// command
+	int          fromID, toID;			// IDs for source and destination stations
+	string       options;				// rest of the line
+
+	ss >> cmd;
+
+	if (cmd == "exit")
+		return false;
+
+	// show info about station choosen by user
+	// the rest of the line may narrow it down to a time of the week
+	if (cmd == "info" && ss >> fromID)
+	{
+		STAT_TIMER(timer, Stat::Info);
+
+		getline(ss, options);
+
+		ShowInfo(out, DivvyGraph, stations, index, buckets, fromID, options);
+	}
+
+	// show trips info from source to destination station choosen by user
+	// the rest of the line may narrow it down to a time of the week
+	else if (cmd == "trips" && ss >> fromID >> toID)
+	{
+		STAT_TIMER(timer, Stat::Trips);
+
+		getline(ss, options);
+
+		ShowTrips(out, DivvyGraph, stations, index, buckets, fromID, toID, options);
+	}
+
+	// show the trips arriving at a station, optionally at a time of the week
+	else if (cmd == "arrivals" && ss >> toID)
+	{
+		STAT_TIMER(timer, Stat::Arrivals);
+
+		getline(ss, options);
+
+		ShowArrivals(out, DivvyGraph, stations, index, buckets, toID, options);
+	}
+
+	// perform breath first search, display edges in order they were traversed
+	// or, with "levels", level by level
+	else if (cmd == "bfs" && ss >> fromID)
+	{
+		STAT_TIMER(timer, Stat::BFSCommand);
+
+		getline(ss, options);
+
+		BFS(out, DivvyGraph, stations, index, fromID, options);
+	}
+
+	// shortest path from source to destination station, the rest of
+	// the line holds the options
+	else if (cmd == "path" && ss >> fromID >> toID)
+	{
+		STAT_TIMER(timer, Stat::Path);
+
+		getline(ss, options);
+
+		ShowPath(out, paths, stations, index, fromID, toID, options);
+	}
+
+	// k stations closest to the given coordinates
+	else if (cmd == "near")
+	{
+		STAT_TIMER(timer, Stat::Near);
+
+		double latitude, longitude;
+		int    k;
+
+		if (!(ss >> latitude >> longitude >> k))
+			out << "**Invalid command, try again..." << '\n';
+		else if (!(fabs(latitude) <= 90 && fabs(longitude) <= 180))
+			out << "** No such coordinates..." << '\n';
+		else
+			ShowNear(out, spatial, stations, latitude, longitude, k);
+	}
+
+	// stations within the given # of meters from a station
+	else if (cmd == "within")
+	{
+		STAT_TIMER(timer, Stat::Within);
+
+		double meters;
+
+		if (ss >> fromID >> meters)
+			ShowWithin(out, spatial, stations, index, fromID, meters);
+		else
+			out << "**Invalid command, try again..." << '\n';
+	}
+
+	// diplay the whole graph
+	else if (cmd == "debug")
+	{
+		STAT_TIMER(timer, Stat::Debug);
+
+		DivvyGraph.PrintGraph("Divvy Graph", out);
+	}
+
+	// trip durations on a route, from the trip store
+	else if (cmd == "durations" && ss >> fromID >> toID)
+	{
+		STAT_TIMER(timer, Stat::Durations);
+
+		getline(ss, options);
+
+		ShowDurations(out, DivvyGraph, stations, index, trips, fromID, toID, options);
+	}
+
+	// usertypes and genders of the riders leaving a station
+	else if (cmd == "riders" && ss >> fromID)
+	{
+		STAT_TIMER(timer, Stat::Riders);
+
+		getline(ss, options);
+
+		ShowRiders(out, DivvyGraph, stations, index, trips, fromID, options);
+	}
+
+	// age histogram of the riders leaving a station
+	else if (cmd == "ages" && ss >> fromID)
+	{
+		STAT_TIMER(timer, Stat::Ages);
+
+		getline(ss, options);
+
+		ShowAges(out, DivvyGraph, stations, index, trips, fromID, options);
+	}
+
+	// rebalancing moves out of and into a station
+	else if (cmd == "moves" && ss >> fromID)
+	{
+		STAT_TIMER(timer, Stat::Moves);
+
+		ShowMoves(out, DivvyGraph, stations, index, trips, fromID);
+	}
+
+	// the busiest rebalancing flows, 10 unless given
+	else if (cmd == "rebalancing")
+	{
+		STAT_TIMER(timer, Stat::Rebalancing);
+
+		int k = 10;
+		if (!(ss >> k))
+			k = 10;
+
+		ShowRebalancing(out, DivvyGraph, stations, index, trips, k);
+	}
+
+	// the stations running out of bikes or docks by the end of an hour,
+	// the worst 10 of each unless given
+	else if (cmd == "imbalance")
+	{
+		STAT_TIMER(timer, Stat::Imbalance);
+
+		int hour, k = 10;
+
+		if (ss >> hour) {
+			if (!(ss >> k))
+				k = 10;
+			ShowImbalance(out, DivvyGraph, stations, index, trips, hour, k);
+		}
+		else
+			out << "**Invalid command, try again..." << '\n';
+	}
+
+	// strongly / weakly connected components and the isolated stations
+	else if (cmd == "components")
+	{
+		STAT_TIMER(timer, Stat::Components);
+
+		ShowComponents(out, DivvyGraph, stations, index);
+	}
+
+	// the components of a station
+	else if (cmd == "component" && ss >> fromID)
+	{
+		STAT_TIMER(timer, Stat::Component);
+
+		ShowComponent(out, DivvyGraph, stations, index, fromID);
+	}
+
+	// the OD matrix of every station, or of some, written to a file
+	else if (cmd == "od")
+	{
+		STAT_TIMER(timer, Stat::OD);
+
+		getline(ss, options);
+
+		ShowODMatrix(out, DivvyGraph, stations, index, spatial, od, options);
+	}
+
+	// latency and throughput of the instrumented operations so far
+	else if (cmd == "stats")
+	{
+		ReportStats(out);
+	}
+
+	// invalid command, or its arguments
+	else
+	{
+		out << "**Invalid command, try again..." << '\n';
+	}
+
+	return true;
+}
+
+
+//
+// RunBatch:
+//
+// Runs every command line of queries, up to an exit, and writes each
+// one (after a ">> " prompt) followed by its output to cout.  The
+// queries are taken in blocks; the queries of a block run on numThreads
+// threads, each writing into its own buffer, and the buffers are then
+// written out in the original order with a single write per block.
+// A block ends at an exit, so no query after it is run.
+//
+void RunBatch(istream& queries, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index,
+	TimeBuckets& buckets, TripStore& trips, ODMatrix& od, SpatialIndex& spatial, int numThreads)
+{
+	const int BlockSize = 4096;		// queries per block
+
+	numThreads = max(numThreads, 1);
+
+	// one path engine per thread, reused across the blocks
+	vector<PathEngine> paths;
+	paths.reserve(numThreads);
+	for (int t = 0; t < numThreads; t++)
+		paths.emplace_back(DivvyGraph, stations, index);
+
+	vector<string> block;			// command lines of this block
+	vector<string> results;			// and their output
+	string         line;
+	bool           done = false;
+
+	while (!done)
+	{
+		// read in the next block, blank lines skipped, up to an exit
+		block.clear();
+		while ((int)block.size() < BlockSize && getline(queries, line)) {
+			string cmd;
+			if (!(stringstream(line) >> cmd))
+				continue;
+
+			if (cmd == "exit") {
+				done = true;
+				break;
+			}
+			block.push_back(line);
+		}
+		if (block.empty())
+			break;
+
+		results.assign(block.size(), string());
+
+		// each thread runs every numThreads'th query
+		auto worker = [&](int t) {
+			ostringstream out;
+
+			for (size_t q = t; q < block.size(); q += numThreads) {
+				out.str("");
+				out << ">> " << block[q] << '\n';
+
+				RunQuery(out, block[q], DivvyGraph, stations, index, buckets, trips, od, paths[t], spatial);
+
+				results[q] = out.str();
+			}
+		};
+
+		int numWorkers = (int)min((size_t)numThreads, block.size());
+		if (numWorkers == 1) {
+			worker(0);
+		}
+		else {
+			vector<thread> threads;
+			for (int t = 0; t < numWorkers; t++)
+				threads.push_back(thread(worker, t));
+			for (thread& th : threads)
+				th.join();
+		}
+
+		// stitch the block together and write it at once
+		size_t size = 0;
+		for (string& r : results)
+			size += r.size();
+
+		string output;
+		output.reserve(size);
+		for (string& r : results)
+			output += r;
+
+		cout.write(output.data(), output.size());
+	}
+
+	cout.flush();
+}
+
+//
+// find station by given id and return the station object,
+// station always exists if this function is called
+//
+Station& FindStation(int id, vector<Station>& stations, StationIndex& index)
+{
+	// look up the position in the station vector
+	return stations[index.Find(id)];
+}
+
+
+//
+// find station ID by given name, 
+// returns station ID or 0 if not found
+//
+int FindIDByName(const string& name, vector<Station>& stations, StationIndex& index) 
+{
+	// look up the position in the station vector through the graph's name index
+	int pos = index.FindByName(name);
+	if (pos != -1)
+		return stations[pos].ID;	// found
+
+	return 0;						// not found
+}
+
+
+//
+// verifies if station exists in vector of Stations,
+// returns true if station exist, false is returned otherwise 
+//
+bool StationExist(int id, StationIndex& index) 
+{
+	return index.Find(id) != -1;
+}
+
+
+//
+// collects the info about the station choosen by user,
+// function uses other functions for collecting informations, 
+// then displays them to the user; options may narrow the trips
+// down to a time of the week (see ParseBucketMask)
+// 
+void ShowInfo(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TimeBuckets& buckets,
+	int userVal, string options)
+{
+	BucketMask mask;
+	string     label;
+
+	// verify the options
+	if (!ParseBucketMask(options, mask, label)) {
+		out << "**Invalid time option..." << '\n';
+		return;
+	}
+
+	// verify if station exist
+	if (!(StationExist(userVal, index))) {
+		out << "** No such station..." << '\n';
+		return;
+	}
+
+	// narrowed down to a time of the week
+	if (!label.empty()) {
+		ShowInfoByTime(out, DivvyGraph, stations, index, buckets, userVal, mask, label);
+		return;
+	}
+
+	// find station and its vertex
+	Station& result = FindStation(userVal, stations, index);
+	int      src = index.VertexOf(index.Find(userVal));
+
+	// display results
+	out << result.Name << '\n';
+	out << "(" << result.Latitude << "," << result.Longitude << ")" << '\n';
+	out << "Capacity: " << result.Capacity << '\n';
+	out << "# of destination stations: " << DivvyGraph.GetOutDegree(src) << '\n';
+	out << "# of trips to those stations: " << DivvyGraph.GetOutTrips(src) << '\n';
+	out << "# of source stations: " << DivvyGraph.GetInDegree(src) << '\n';
+	out << "# of trips from those stations: " << DivvyGraph.GetInTrips(src) << '\n';
+	out << "Net trips (in - out): " << DivvyGraph.GetInTrips(src) - DivvyGraph.GetOutTrips(src) << '\n';
+	out << "Station: trips" << '\n';
+
+	// display info about trips, walking the destinations in name order
+	const vector<int>&               order = DivvyGraph.GetNameOrder();
+	const vector<Graph::VertexType>& dests = DivvyGraph.GetDests();
+	const vector<Graph::WeightType>& weights = DivvyGraph.GetWeights();
+	int                              begin = (src != -1) ? DivvyGraph.GetOffsets()[src] : 0;
+
+	for (int i = begin; i < begin + DivvyGraph.GetOutDegree(src); i++) {
+		int e = order[i];
+		int pos = index.FindByVertex(dests[e]);
+
+		// name, ID and # of trips
+		if (pos != -1)
+			out << "   " << stations[pos].Name << " (" << stations[pos].ID << "): ";
+		else
+			out << "   " << DivvyGraph.GetName(dests[e]) << " (0): ";
+		out << weights[e] << '\n';
+	}
+}
+
+
+//
+// same as ShowInfo, but counts only the trips in the buckets of mask;
+// destinations without such trips are left out
+//
+void ShowInfoByTime(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TimeBuckets& buckets,
+	int userVal, BucketMask& mask, string label)
+{
+	// find station and its vertex
+	Station& result = FindStation(userVal, stations, index);
+	int      src = index.VertexOf(index.Find(userVal));
+
+	const vector<int>&               order = DivvyGraph.GetNameOrder();
+	const vector<Graph::VertexType>& dests = DivvyGraph.GetDests();
+	int                              begin = (src != -1) ? DivvyGraph.GetOffsets()[src] : 0;
+	int                              end = begin + DivvyGraph.GetOutDegree(src);
+
+	// # of destinations and trips in the chosen buckets
+	int numDests = 0, total = 0;
+	for (int i = begin; i < end; i++) {
+		int count = buckets.Count(order[i], mask);
+
+		if (count > 0) {
+			numDests++;
+			total += count;
+		}
+	}
+
+	// and of sources
+	const vector<int>& inOffsets = DivvyGraph.GetInOffsets();
+	const vector<int>& inEdges = DivvyGraph.GetInEdges();
+	int numSources = 0, inbound = 0;
+
+	for (int i = (src != -1) ? inOffsets[src] : 0; src != -1 && i < inOffsets[src + 1]; i++) {
+		int count = buckets.Count(inEdges[i], mask);
+
+		if (count > 0) {
+			numSources++;
+			inbound += count;
+		}
+	}
+
+	// display results
+	out << result.Name << '\n';
+	out << "(" << result.Latitude << "," << result.Longitude << ")" << '\n';
+	out << "Capacity: " << result.Capacity << '\n';
+	out << "Time: " << label << '\n';
+	out << "# of destination stations: " << numDests << '\n';
+	out << "# of trips to those stations: " << total << '\n';
+	out << "# of source stations: " << numSources << '\n';
+	out << "# of trips from those stations: " << inbound << '\n';
+	out << "Net trips (in - out): " << inbound - total << '\n';
+	out << "Station: trips" << '\n';
+	// display info about trips
+	for (int i = begin; i < end; i++) {
+		int count = buckets.Count(order[i], mask);
+		if (count == 0)
+			continue;
+
+		int pos = index.FindByVertex(dests[order[i]]);
+		if (pos != -1)
+			out << "   " << stations[pos].Name << " (" << stations[pos].ID << "): ";
+		else
+			out << "   " << DivvyGraph.GetName(dests[order[i]]) << " (0): ";
+		out << count << '\n';
+	}
+}
+
+
+//
+// displays the stations trips to the given station come from, by name,
+// with the # of trips from each; options may narrow the trips down to
+// a time of the week, as for info
+//
+void ShowArrivals(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TimeBuckets& buckets,
+	int toID, string options)
+{
+	BucketMask mask;
+	string     label;
+
+	// verify the options
+	if (!ParseBucketMask(options, mask, label)) {
+		out << "**Invalid time option..." << '\n';
+		return;
+	}
+
+	// verify if station exist
+	if (!(StationExist(toID, index))) {
+		out << "** No such station..." << '\n';
+		return;
+	}
+
+	// find station and its vertex
+	Station& result = FindStation(toID, stations, index);
+	int      dest = index.VertexOf(index.Find(toID));
+
+	const vector<int>&               inOffsets = DivvyGraph.GetInOffsets();
+	const vector<Graph::VertexType>& inSources = DivvyGraph.GetInSources();
+	const vector<int>&               inEdges = DivvyGraph.GetInEdges();
+	const vector<Graph::WeightType>& weights = DivvyGraph.GetWeights();
+	int                              begin = (dest != -1) ? inOffsets[dest] : 0;
+	int                              end = (dest != -1) ? inOffsets[dest + 1] : 0;
+
+	// trips on in-edge i, in the chosen buckets if any
+	auto trips = [&](int i) {
+		return label.empty() ? (int)weights[inEdges[i]] : buckets.Count(inEdges[i], mask);
+	};
+
+	int numSources = 0, total = 0;
+	for (int i = begin; i < end; i++) {
+		int count = trips(i);
+
+		if (count > 0) {
+			numSources++;
+			total += count;
+		}
+	}
+
+	// display results
+	out << result.Name << '\n';
+	out << "(" << result.Latitude << "," << result.Longitude << ")" << '\n';
+	out << "Capacity: " << result.Capacity << '\n';
+	if (!label.empty())
+		out << "Time: " << label << '\n';
+	out << "# of source stations: " << numSources << '\n';
+	out << "# of trips from those stations: " << total << '\n';
+	out << "Station: trips" << '\n';
+	// display info about trips
+	for (int i = begin; i < end; i++) {
+		int count = trips(i);
+		if (count == 0)
+			continue;
+
+		int pos = index.FindByVertex(inSources[i]);
+		if (pos != -1)
+			out << "   " << stations[pos].Name << " (" << stations[pos].ID << "): ";
+		else
+			out << "   " << DivvyGraph.GetName(inSources[i]) << " (0): ";
+		out << count << '\n';
+	}
+}
+
+
+//
+// formats a # of seconds as minutes with one decimal
+//
+static string Minutes(double seconds)
+{
+	char text[32];
+
+	snprintf(text, sizeof(text), "%.1f minutes", seconds / 60);
+	return text;
+}
+
+
+//
+// formats part as a percentage of whole with one decimal
+//
+static string Percent(int part, int whole)
+{
+	char text[32];
+
+	snprintf(text, sizeof(text), "%.1f%%", (whole > 0) ? 100.0 * part / whole : 0.0);
+	return text;
+}
+
+
+//
+// the range of trips in the store leaving the vertex of station id, an
+// empty range if the station has no vertex
+//
+static void StationTrips(Graph& DivvyGraph, StationIndex& index, TripStore& trips, int id, int& begin, int& end)
+{
+	int v = index.VertexOf(index.Find(id));
+
+	begin = end = 0;
+	if (v != -1) {
+		const vector<int>& offsets = DivvyGraph.GetOffsets();
+
+		begin = trips.EdgeBegin(offsets[v]);
+		end = trips.EdgeBegin(offsets[v + 1]);
+	}
+}
+
+
+//
+// ShowDurations
+// displays the # of trips from source station to destination station
+// and their mean, shortest and longest durations; options may narrow
+// the trips down to a time of the week
+//
+void ShowDurations(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TripStore& trips,
+	int fromID, int toID, string options)
+{
+	BucketMask mask;
+	string     label;
+
+	// verify the options
+	if (!ParseBucketMask(options, mask, label)) {
+		out << "**Invalid time option..." << '\n';
+		return;
+	}
+
+	// verify if both stations exists
+	if (!(StationExist(fromID, index)) || !(StationExist(toID, index))) {
+		out << "** One of those stations doesn't exist..." << '\n';
+		return;
+	}
+
+	if (!trips.EnsureLoaded(DivvyGraph, index)) {
+		out << "**Trip details are not available..." << '\n';
+		return;
+	}
+
+	// trips of the route, if there is one
+	int e = DivvyGraph.FindEdge(index.VertexOf(index.Find(fromID)), index.VertexOf(index.Find(toID)));
+	TripSummary summary = trips.Summarize(trips.EdgeBegin(e), trips.EdgeEnd(e), mask, label.empty());
+
+	// display results
+	out << GetStationName(fromID, stations, index) << " -> " << GetStationName(toID, stations, index) << '\n';
+	if (!label.empty())
+		out << "Time: " << label << '\n';
+	out << "# of trips: " << summary.Trips << '\n';
+	if (summary.Trips == 0)
+		return;
+	out << "Mean duration: " << Minutes((double)summary.TotalDuration / summary.Trips) << '\n';
+	out << "Shortest trip: " << Minutes(summary.MinDuration) << '\n';
+	out << "Longest trip: " << Minutes(summary.MaxDuration) << '\n';
+}
+
+
+//
+// ShowRiders
+// displays the # of trips leaving the station, their mean duration
+// and the share of each usertype and gender; options may narrow the
+// trips down to a time of the week
+//
+void ShowRiders(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TripStore& trips,
+	int fromID, string options)
+{
+	BucketMask mask;
+	string     label;
+
+	// verify the options
+	if (!ParseBucketMask(options, mask, label)) {
+		out << "**Invalid time option..." << '\n';
+		return;
+	}
+
+	// verify if station exist
+	if (!(StationExist(fromID, index))) {
+		out << "** No such station..." << '\n';
+		return;
+	}
+
+	if (!trips.EnsureLoaded(DivvyGraph, index)) {
+		out << "**Trip details are not available..." << '\n';
+		return;
+	}
+
+	int begin, end;
+	StationTrips(DivvyGraph, index, trips, fromID, begin, end);
+	TripSummary summary = trips.Summarize(begin, end, mask, label.empty());
+
+	TripStore::Dictionary& userTypes = trips.GetUserTypeNames();
+	TripStore::Dictionary& genders = trips.GetGenderNames();
+
+	// display results
+	out << GetStationName(fromID, stations, index) << '\n';
+	if (!label.empty())
+		out << "Time: " << label << '\n';
+	out << "# of trips from the station: " << summary.Trips << '\n';
+	if (summary.Trips == 0)
+		return;
+	out << "Mean duration: " << Minutes((double)summary.TotalDuration / summary.Trips) << '\n';
+
+	out << "User type: trips" << '\n';
+	for (int c = 0; c < userTypes.Size(); c++) {
+		if (summary.UserTypes[c] > 0) {
+			out << "   " << (userTypes.Decode(c).empty() ? "unknown" : userTypes.Decode(c)) << ": "
+				<< summary.UserTypes[c] << " (" << Percent(summary.UserTypes[c], summary.Trips) << ")" << '\n';
+		}
+	}
+
+	out << "Gender: trips" << '\n';
+	for (int c = 0; c < genders.Size(); c++) {
+		if (summary.Genders[c] > 0) {
+			out << "   " << (genders.Decode(c).empty() ? "unknown" : genders.Decode(c)) << ": "
+				<< summary.Genders[c] << " (" << Percent(summary.Genders[c], summary.Trips) << ")" << '\n';
+		}
+	}
+}
+
+
+//
+// ShowAges
+// displays the ages of the riders leaving the station in bands of 10
+// years, over the trips whose rider gave a birth year; options may
+// narrow the trips down to a time of the week
+//
+void ShowAges(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TripStore& trips,
+	int fromID, string options)
+{
+	static const char *bandNames[NumAgeBands] = {
+		"under 20", "20-29", "30-39", "40-49", "50-59", "60-69", "70 and over"
+	};
+
+	BucketMask mask;
+	string     label;
+
+	// verify the options
+	if (!ParseBucketMask(options, mask, label)) {
+		out << "**Invalid time option..." << '\n';
+		return;
+	}
+
+	// verify if station exist
+	if (!(StationExist(fromID, index))) {
+		out << "** No such station..." << '\n';
+		return;
+	}
+
+	if (!trips.EnsureLoaded(DivvyGraph, index)) {
+		out << "**Trip details are not available..." << '\n';
+		return;
+	}
+
+	int begin, end;
+	StationTrips(DivvyGraph, index, trips, fromID, begin, end);
+	TripSummary summary = trips.Summarize(begin, end, mask, label.empty());
+
+	// display results
+	out << GetStationName(fromID, stations, index) << '\n';
+	if (!label.empty())
+		out << "Time: " << label << '\n';
+	out << "# of trips with a rider age: " << summary.WithAge << '\n';
+	if (summary.WithAge == 0)
+		return;
+
+	char meanAge[32];
+	snprintf(meanAge, sizeof(meanAge), "%.1f", (double)summary.TotalAge / summary.WithAge);
+	out << "Mean age: " << meanAge << '\n';
+
+	out << "Age: trips" << '\n';
+	for (int b = 0; b < NumAgeBands; b++)
+		out << "   " << bandNames[b] << ": " << summary.AgeBands[b] << " (" << Percent(summary.AgeBands[b], summary.WithAge) << ")" << '\n';
+}
+
+
+//
+// displays a station of the graph by vertex: "name (id)"
+//
+static void ShowVertex(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, int v)
+{
+	int pos = index.FindByVertex(v);
+
+	if (pos != -1)
+		out << stations[pos].Name << " (" << stations[pos].ID << ")";
+	else
+		out << DivvyGraph.GetName(v) << " (0)";
+}
+
+
+//
+// ShowMoves
+// displays the rebalancing moves out of and into the station, i.e. the
+// bikes trucked away after a trip ended there and the bikes trucked in
+// before a trip started there, busiest stations first
+//
+void ShowMoves(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TripStore& trips,
+	int id)
+{
+	// verify if station exist
+	if (!(StationExist(id, index))) {
+		out << "** No such station..." << '\n';
+		return;
+	}
+
+	if (!trips.EnsureLoaded(DivvyGraph, index)) {
+		out << "**Trip details are not available..." << '\n';
+		return;
+	}
+
+	int v = index.VertexOf(index.Find(id));
+
+	// (count, vertex) of the moves in [begin, end) of the given arrays,
+	// busiest first
+	auto collect = [&](const vector<int>& offsets, const vector<int>& others, const vector<int>& counts,
+		int& total) {
+		vector<pair<int, int>> moves;
+
+		total = 0;
+		if (v != -1) {
+			for (int i = offsets[v]; i < offsets[v + 1]; i++) {
+				moves.push_back(make_pair(-counts[i], others[i]));
+				total += counts[i];
+			}
+		}
+		sort(moves.begin(), moves.end());
+		return moves;
+	};
+
+	MoveEdges& edges = trips.GetMoves();
+	int        movedOut, movedIn;
+
+	vector<pair<int, int>> to = collect(edges.GetOffsets(), edges.GetDests(), edges.GetWeights(), movedOut);
+	vector<pair<int, int>> from = collect(edges.GetInOffsets(), edges.GetInSources(), edges.GetInWeights(), movedIn);
+
+	// display results
+	out << GetStationName(id, stations, index) << '\n';
+	out << "# of bikes moved out: " << movedOut << " (to " << to.size() << " stations)" << '\n';
+	out << "# of bikes moved in: " << movedIn << " (from " << from.size() << " stations)" << '\n';
+	out << "Net bikes moved in: " << movedIn - movedOut << '\n';
+
+	out << "Moved to: bikes" << '\n';
+	for (auto& m : to) {
+		out << "   ";
+		ShowVertex(out, DivvyGraph, stations, index, m.second);
+		out << ": " << -m.first << '\n';
+	}
+
+	out << "Moved from: bikes" << '\n';
+	for (auto& m : from) {
+		out << "   ";
+		ShowVertex(out, DivvyGraph, stations, index, m.second);
+		out << ": " << -m.first << '\n';
+	}
+}
+
+
+//
+// ShowRebalancing
+// displays the totals of the bike trajectories and the k busiest
+// rebalancing flows between two stations
+//
+void ShowRebalancing(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TripStore& trips,
+	int k)
+{
+	if (!trips.EnsureLoaded(DivvyGraph, index)) {
+		out << "**Trip details are not available..." << '\n';
+		return;
+	}
+
+	const vector<int>& offsets = trips.GetMoves().GetOffsets();
+	const vector<int>& dests = trips.GetMoves().GetDests();
+	const vector<int>& weights = trips.GetMoves().GetWeights();
+
+	// (count, move edge) of the k busiest flows
+	vector<pair<int, int>> flows;
+	for (int i = 0; i < (int)dests.size(); i++)
+		flows.push_back(make_pair(-weights[i], i));
+
+	k = max(0, min(k, (int)flows.size()));
+	partial_sort(flows.begin(), flows.begin() + k, flows.end());
+
+	// display results
+	out << "# of bikes: " << trips.GetBikes().GetNumBikes() << '\n';
+	out << "# of trips: " << trips.GetNumTrips() << '\n';
+	out << "# of moves: " << trips.GetNumMoves() << " (after "
+		<< Percent((int)trips.GetNumMoves(), trips.GetNumTrips()) << " of the trips)" << '\n';
+	out << "# of station pairs: " << dests.size() << '\n';
+
+	out << "Flow: bikes" << '\n';
+	for (int f = 0; f < k; f++) {
+		int e = flows[f].second;
+		int src = (int)(upper_bound(offsets.begin(), offsets.end(), e) - offsets.begin()) - 1;
+
+		out << "   ";
+		ShowVertex(out, DivvyGraph, stations, index, src);
+		out << " -> ";
+		ShowVertex(out, DivvyGraph, stations, index, dests[e]);
+		out << ": " << -flows[f].first << '\n';
+	}
+}
+
+
+//
+// ShowImbalance
+// displays the k stations short of the most bikes, and the k short of
+// the most docks, by the end of the hour on an average day (see
+// DockFlows::Project()); stations of unknown capacity are left out
+//
+void ShowImbalance(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TripStore& trips,
+	int hour, int k)
+{
+	if (hour < 0 || hour > 23) {
+		out << "**Invalid hour, 0-23..." << '\n';
+		return;
+	}
+
+	if (!trips.EnsureLoaded(DivvyGraph, index)) {
+		out << "**Trip details are not available..." << '\n';
+		return;
+	}
+
+	DockFlows& flows = trips.GetFlows();
+
+	// (-shortfall, vertex) of the stations running empty, and filling up
+	vector<pair<double, int>>       empty, full;
+	vector<DockFlows::Projection>   projections(DivvyGraph.GetNumVertices());
+
+	for (int v = 0; v < DivvyGraph.GetNumVertices(); v++) {
+		int pos = index.FindByVertex(v);
+		if (pos == -1 || stations[pos].Capacity <= 0)
+			continue;
+
+		projections[v] = flows.Project(v, stations[pos].Capacity, hour);
+		if (projections[v].EmptyAt != -1)
+			empty.push_back(make_pair(-projections[v].BikesShort, v));
+		if (projections[v].FullAt != -1)
+			full.push_back(make_pair(-projections[v].DocksShort, v));
+	}
+
+	// display results
+	out << "By the end of hour " << hour << ", on an average of " << flows.GetNumDays()
+		<< " days, half full at midnight" << '\n';
+
+	char line[64];
+	int  kEmpty = max(0, min(k, (int)empty.size()));
+	int  kFull = max(0, min(k, (int)full.size()));
+
+	partial_sort(empty.begin(), empty.begin() + kEmpty, empty.end());
+	partial_sort(full.begin(), full.begin() + kFull, full.end());
+
+	out << "# of stations running empty: " << empty.size() << '\n';
+	for (int i = 0; i < kEmpty; i++) {
+		int v = empty[i].second;
+		snprintf(line, sizeof(line), ": empty from hour %d, %.1f bikes short, capacity %d",
+			projections[v].EmptyAt, projections[v].BikesShort, stations[index.FindByVertex(v)].Capacity);
+
+		out << "   ";
+		ShowVertex(out, DivvyGraph, stations, index, v);
+		out << line << '\n';
+	}
+
+	out << "# of stations filling up: " << full.size() << '\n';
+	for (int i = 0; i < kFull; i++) {
+		int v = full[i].second;
+		snprintf(line, sizeof(line), ": full from hour %d, %.1f docks short, capacity %d",
+			projections[v].FullAt, projections[v].DocksShort, stations[index.FindByVertex(v)].Capacity);
+
+		out << "   ";
+		ShowVertex(out, DivvyGraph, stations, index, v);
+		out << line << '\n';
+	}
+}
+
+
+//
+// ShowComponents
+// displays the strongly and weakly connected components of the trip
+// graph, and the isolated stations: those with no trips to or from
+// any other station
+//
+void ShowComponents(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index)
+{
+	const vector<int>&               sccSizes = DivvyGraph.GetSCCSizes();
+	const vector<int>&               wccSizes = DivvyGraph.GetWCCSizes();
+	const vector<Graph::VertexType>& wccs = DivvyGraph.GetWCCs();
+	int                              n = DivvyGraph.GetNumVertices();
+
+	// components are numbered largest first
+	int singleSCCs = (int)count(sccSizes.begin(), sccSizes.end(), 1);
+	int isolated = (int)count(wccSizes.begin(), wccSizes.end(), 1);
+
+	out << "# of stations: " << n << '\n';
+	out << "# of strongly connected components: " << sccSizes.size() << '\n';
+	if (!sccSizes.empty()) {
+		out << "   largest: " << sccSizes[0] << " stations (" << Percent(sccSizes[0], n) << ")" << '\n';
+		out << "   single stations: " << singleSCCs << '\n';
+	}
+	out << "# of weakly connected components: " << wccSizes.size() << '\n';
+	if (!wccSizes.empty())
+		out << "   largest: " << wccSizes[0] << " stations (" << Percent(wccSizes[0], n) << ")" << '\n';
+
+	out << "# of isolated stations: " << isolated << '\n';
+	for (int v = 0; v < n && isolated > 0; v++) {
+		if (wccSizes[wccs[v]] == 1) {
+			out << "   ";
+			ShowVertex(out, DivvyGraph, stations, index, v);
+			out << '\n';
+		}
+	}
+}
+
+
+//
+// ShowComponent
+// displays the strongly and weakly connected components of a station,
+// and the other stations of its strongly connected component if it is
+// small
+//
+void ShowComponent(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, int id)
+{
+	const int MaxListed = 20;		// most stations listed
+
+	// verify if station exist
+	if (!(StationExist(id, index))) {
+		out << "** No such station..." << '\n';
+		return;
+	}
+
+	int v = index.VertexOf(index.Find(id));
+
+	out << GetStationName(id, stations, index) << '\n';
+	if (v == -1 || !DivvyGraph.IsFrozen()) {
+		out << "**Component details are not available..." << '\n';
+		return;
+	}
+
+	const vector<Graph::VertexType>& sccs = DivvyGraph.GetSCCs();
+	const vector<Graph::VertexType>& wccs = DivvyGraph.GetWCCs();
+	int                              scc = sccs[v];
+	int                              wcc = wccs[v];
+	int                              sccSize = DivvyGraph.GetSCCSizes()[scc];
+	int                              wccSize = DivvyGraph.GetWCCSizes()[wcc];
+
+	out << "Strongly connected component: " << scc << " (" << sccSize << " stations)" << '\n';
+	out << "Weakly connected component: " << wcc << " (" << wccSize << " stations)" << '\n';
+	if (wccSize == 1)
+		out << "Isolated: no trips to or from other stations" << '\n';
+
+	if (sccSize > 1 && sccSize <= MaxListed) {
+		out << "Mutually reachable:" << '\n';
+		for (int u = 0; u < DivvyGraph.GetNumVertices(); u++) {
+			if (u != v && (int)sccs[u] == scc) {
+				out << "   ";
+				ShowVertex(out, DivvyGraph, stations, index, u);
+				out << '\n';
+			}
+		}
+	}
+}
+
+
+//
+// returns the name of the station based on given ID if station is found,
+// otherwise empty string is returned; the name is not copied
+//
+string_view GetStationName(int id, vector<Station>& stations, StationIndex& index) 
+{
+	// index lookup, returns the name if found, empty otherwise
+	int pos = index.Find(id);
+	if (pos != -1)
+		return stations[pos].Name;	// found
+
+	return string_view();			// not found
+}
+
+
+//
+// by using other functions grabs the info about trip for source station
+// to destination station and the displays the station names
+// along with the number of trips from source station to destination station;
+// options may narrow the trips down to a time of the week
+//
+void ShowTrips(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TimeBuckets& buckets,
+	int fromID, int toID, string options) 
+{
+	BucketMask mask;
+	string     label;
+
+	// verify the options
+	if (!ParseBucketMask(options, mask, label)) {
+		out << "**Invalid time option..." << '\n';
+		return;
+	}
+
+	// verify if both stations exists
+	if (!(StationExist(fromID, index)) || !(StationExist(toID, index))) {
+		out << "** One of those stations doesn't exist..." << '\n';
+		return;
+	}
+
+	// grab the vertices of fromID and toID
+	int from = index.VertexOf(index.Find(fromID));
+	int to = index.VertexOf(index.Find(toID));
+
+	// display names
+	out << GetStationName(fromID, stations, index) << " -> " << GetStationName(toID, stations, index) << '\n';
+	// display num,ber of trips from station A to station B
+	if (label.empty()) {
+		out << "# of trips: " << DivvyGraph.GetEdgeWeight(from, to) << '\n';
+		return;
+	}
+
+	// only the trips in the chosen buckets
+	int e = DivvyGraph.FindEdge(from, to);
+	out << "# of trips (" << label << "): " << buckets.Count(e, mask) << '\n';
+}
+
+
+//
+// BFS
+// calls the graph's BFS which returns vector with vertex #'s in
+// order they were traversed, then maps every vertex to its station
+// through the station index and displays the IDs.  With the "levels"
+// option the direction-optimizing BFSEngine runs instead, and the
+// stations are displayed a level (# of hops from the start) at a time
+//
+void BFS(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, int fromID, string options)
+{
+	stringstream ss(options);
+	string       word;
+	bool         levels = false;
+
+	while (ss >> word) {
+		if (word == "levels")
+			levels = true;
+		else {
+			out << "**Invalid command, try again..." << '\n';
+			return;
+		}
+	}
+
+	// verify if station exist
+	if (!(StationExist(fromID, index))) {
+		out << "** No such station..." << '\n';
+		return;
+	}
+
+	int start = index.VertexOf(index.Find(fromID));
+
+	if (levels) {
+		BFSEngine          engine(DivvyGraph);
+		const vector<int>& order = engine.Run(start, 1);
+
+		out << "# of stations: " << order.size() << '\n';
+
+		// the order holds the levels one after the other
+		for (size_t i = 0; i < order.size(); i++) {
+			int depth = engine.GetDepth(order[i]);
+			if (i == 0 || depth != engine.GetDepth(order[i - 1]))
+				out << ((i == 0) ? "" : "#\n") << "Level " << depth << ": ";
+
+			int pos = index.FindByVertex(order[i]);
+			out << ((pos != -1) ? stations[pos].ID : 0) << ", ";
+		}
+
+		out << "#" << '\n';
+		return;
+	}
+
+	// run BFS over vertex #'s
+	vector<int> BFSVisited = DivvyGraph.BFS(start);
+
+	out << "# of stations: " << BFSVisited.size() << '\n';
+
+	// for each vertex find the station ID and display
+	for (int v : BFSVisited) {
+		int pos = index.FindByVertex(v);
+		out << ((pos != -1) ? stations[pos].ID : 0) << ", ";
+	}
+
+	out << "#" << '\n';
+}
+
+
+//
+// ShowPath
+// finds the cheapest path from source station to destination station
+// and displays the station IDs along it with its length.  options may
+// name the cost ("distance", the default, "popular" for favoring busy
+// routes, or "hops") and "astar" to use A* instead of Dijkstra
+//
+void ShowPath(ostream& out, PathEngine& paths, vector<Station>& stations, StationIndex& index, int fromID, int toID, string options)
+{
+	// verify if both stations exists
+	if (!(StationExist(fromID, index)) || !(StationExist(toID, index))) {
+		out << "** One of those stations doesn't exist..." << '\n';
+		return;
+	}
+
+	// parse the options
+	PathCost cost = PathCost::Distance;
+	bool     astar = false;
+	string   word;
+
+	stringstream ss(options);
+	while (ss >> word) {
+		if (word == "distance")
+			cost = PathCost::Distance;
+		else if (word == "popular")
+			cost = PathCost::Popularity;
+		else if (word == "hops")
+			cost = PathCost::Hops;
+		else if (word == "astar")
+			astar = true;
+		else {
+			out << "**Invalid path option '" << word << "'..." << '\n';
+			return;
+		}
+	}
+
+	int src = index.VertexOf(index.Find(fromID));
+	int dest = index.VertexOf(index.Find(toID));
+
+	vector<int> path;
+	double      total;
+
+	if (!paths.ShortestPath(src, dest, cost, astar, path, total)) {
+		out << "** No path between those stations..." << '\n';
+		return;
+	}
+
+	// length of the path in meters, whatever the cost
+	double meters = 0.0;
+	for (size_t i = 1; i < path.size(); i++)
+		meters += paths.Distance(path[i - 1], path[i]);
+
+	out << "# of stations: " << path.size() << '\n';
+
+	// for each vertex find the station ID and display
+	for (int v : path) {
+		int pos = index.FindByVertex(v);
+		out << ((pos != -1) ? stations[pos].ID : 0) << ", ";
+	}
+
+	out << "#" << '\n';
+	out << "Distance: " << (int)(meters + 0.5) << " meters" << '\n';
+	out << "Cost: " << total << '\n';
+}
+
+
+//
+// ShowNear
+// displays the k stations closest to the given coordinates, closest
+// first, with their distance in meters
+//
+void ShowNear(ostream& out, SpatialIndex& spatial, vector<Station>& stations, double latitude, double longitude, int k)
+{
+	vector<SpatialIndex::Hit> hits;
+	spatial.Nearest(latitude, longitude, k, hits);
+
+	out << "# of stations: " << hits.size() << '\n';
+	for (auto& h : hits) {
+		Station& s = stations[h.Pos];
+		out << "   " << s.Name << " (" << s.ID << "): " << (int)(h.Meters + 0.5) << " meters" << '\n';
+	}
+}
+
+
+//
+// ShowWithin
+// displays the other stations at most the given # of meters from the
+// station, closest first, with their distance in meters
+//
+void ShowWithin(ostream& out, SpatialIndex& spatial, vector<Station>& stations, StationIndex& index, int id, double meters)
+{
+	// verify if station exist
+	if (!(StationExist(id, index))) {
+		out << "** No such station..." << '\n';
+		return;
+	}
+
+	int center = index.Find(id);
+
+	vector<SpatialIndex::Hit> hits;
+	spatial.Within(stations[center].Latitude, stations[center].Longitude, meters, hits);
+
+	// the station itself is always a hit
+	hits.erase(remove_if(hits.begin(), hits.end(),
+		[center](const SpatialIndex::Hit& h) { return h.Pos == center; }), hits.end());
+
+	out << "# of stations: " << hits.size() << '\n';
+	for (auto& h : hits) {
+		Station& s = stations[h.Pos];
+		out << "   " << s.Name << " (" << s.ID << "): " << (int)(h.Meters + 0.5) << " meters" << '\n';
+	}
+}
+
+
+//
+// the path od writes the given file to: the file in the directory named
+// by DIVVY_EXPORT_DIR, or in the current directory if that is not set.
+// Only a plain filename is taken, so no export lands elsewhere: returns
+// false for a path with a directory, an absolute path, . or ..
+//
+static bool ExportPath(string filename, string& path)
+{
+	filesystem::path name(filename);
+
+	if (filename.empty() || filename == "." || filename == ".." || name.has_root_path() || name.has_parent_path())
+		return false;
+
+	const char *dir = getenv("DIVVY_EXPORT_DIR");
+	path = (dir != nullptr && *dir != '\0') ? (filesystem::path(dir) / name).string() : filename;
+	return true;
+}
+
+
+//
+// ShowODMatrix
+// writes the trip counts between stations to a file in the export
+// directory (see ExportPath()), as CSV if its name ends in .csv, else
+// in the binary format of odmatrix.h.  The options are the filename,
+// then the stations:
+//   (none)					every station
+//   within <id> <meters>	the station and those within meters of it
+//   <id> <id> ...			those stations
+// and displays the # of trips among them, and for a few stations how
+// many of their trips stay among them
+//
+void ShowODMatrix(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, SpatialIndex& spatial,
+	ODMatrix& od, string options)
+{
+	const int MaxListed = 20;		// most stations listed
+
+	stringstream ss(options);
+	string       filename, path, word;
+	vector<int>  positions;			// stations of the rows and columns, in order
+
+	if (!(ss >> filename)) {
+		out << "**Invalid command, try again..." << '\n';
+		return;
+	}
+	if (!ExportPath(filename, path)) {
+		out << "** Not a plain filename, try again..." << '\n';
+		return;
+	}
+
+	if (!(ss >> word)) {
+		for (int v = 0; v < DivvyGraph.GetNumVertices(); v++) {
+			if (index.FindByVertex(v) != -1)
+				positions.push_back(index.FindByVertex(v));
+		}
+	}
+	else if (word == "within") {
+		int    id;
+		double meters;
+
+		if (!(ss >> id >> meters)) {
+			out << "**Invalid command, try again..." << '\n';
+			return;
+		}
+		if (!(StationExist(id, index))) {
+			out << "** No such station..." << '\n';
+			return;
+		}
+
+		int center = index.Find(id);
+
+		vector<SpatialIndex::Hit> hits;
+		spatial.Within(stations[center].Latitude, stations[center].Longitude, meters, hits);
+
+		// the station first, then the others closest first
+		positions.push_back(center);
+		for (auto& h : hits) {
+			if (h.Pos != center)
+				positions.push_back(h.Pos);
+		}
+	}
+	else {
+		stringstream ids(word + " " + string(istreambuf_iterator<char>(ss), istreambuf_iterator<char>()));
+		int          id;
+
+		while (ids >> id) {
+			if (!(StationExist(id, index))) {
+				out << "** No such station..." << '\n';
+				return;
+			}
+			positions.push_back(index.Find(id));
+		}
+		if (!ids.eof()) {
+			out << "**Invalid command, try again..." << '\n';
+			return;
+		}
+	}
+
+	if (!od.EnsureBuilt(DivvyGraph)) {
+		out << "**OD matrix is not available..." << '\n';
+		return;
+	}
+
+	int              k = (int)positions.size();
+	vector<int>      vertices(k), ids(k);
+	vector<uint32_t> block, rowSums, colSums;
+
+	for (int i = 0; i < k; i++) {
+		vertices[i] = index.VertexOf(positions[i]);
+		ids[i] = stations[positions[i]].ID;
+	}
+
+	od.Extract(vertices, vertices, block);
+	ODMatrix::Sums(block, k, k, rowSums, colSums);
+
+	bool csv = filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".csv") == 0;
+	if (!(csv ? ODMatrix::SaveCSV(path, ids, block) : ODMatrix::SaveBinary(path, ids, block))) {
+		out << "** Unable to write " << path << "..." << '\n';
+		return;
+	}
+
+	long long total = 0;
+	for (uint32_t n : rowSums)
+		total += n;
+
+	out << "OD matrix: " << k << " x " << k << " stations, " << total << " trips among them" << '\n';
+	out << "Written to: " << path << '\n';
+
+	if (k > MaxListed)
+		return;
+
+	const vector<uint32_t>& allOut = od.GetRowSums();
+	const vector<uint32_t>& allIn = od.GetColSums();
+
+	for (int i = 0; i < k; i++) {
+		Station& s = stations[positions[i]];
+		out << "   " << s.Name << " (" << s.ID << "): out " << rowSums[i] << " of " << allOut[vertices[i]]
+			<< ", in " << colSums[i] << " of " << allIn[vertices[i]] << '\n';
+	}
+}
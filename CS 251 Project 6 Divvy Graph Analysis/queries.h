@@ -0,0 +1,76 @@
+//
+// queries.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "graph.h"
+#include "odmatrix.h"
+#include "path.h"
+#include "spatial.h"
+#include "station.h"
+#include "timebuckets.h"
+#include "tripstore.h"
+
+using namespace std;
+
+
+//
+// The query commands (info, arrivals, trips, bfs, components,
+// component, path, near, within, od, debug, stats, and durations,
+// riders, ages, moves, rebalancing, imbalance over the trip store).
+// Each writes its output to the given stream and only reads the graph
+// and the indexes; the trip store and the OD matrix are built by the
+// first query needing them.
+//
+
+
+// function prototypes
+bool RunQuery(ostream& out, string line, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index,
+	TimeBuckets& buckets, TripStore& trips, ODMatrix& od, PathEngine& paths, SpatialIndex& spatial);
+void RunBatch(istream& queries, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index,
+	TimeBuckets& buckets, TripStore& trips, ODMatrix& od, SpatialIndex& spatial, int numThreads);
+void ShowTrips(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TimeBuckets& buckets,
+	int fromID, int toID, string options);
+void ShowInfo(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TimeBuckets& buckets,
+	int userVal, string options);
+void ShowInfoByTime(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TimeBuckets& buckets,
+	int userVal, BucketMask& mask, string label);
+void ShowArrivals(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TimeBuckets& buckets,
+	int toID, string options);
+void ShowDurations(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TripStore& trips,
+	int fromID, int toID, string options);
+void ShowRiders(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TripStore& trips,
+	int fromID, string options);
+void ShowAges(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TripStore& trips,
+	int fromID, string options);
+void ShowMoves(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TripStore& trips,
+	int id);
+void ShowRebalancing(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TripStore& trips,
+	int k);
+void ShowImbalance(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, TripStore& trips,
+	int hour, int k);
+void ShowComponents(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index);
+void ShowComponent(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, int id);
+Station& FindStation(int id, vector<Station>& stations, StationIndex& index);
+int FindIDByName(const string& name, vector<Station>& stations, StationIndex& index);
+bool StationExist(int id, StationIndex& index);
+string_view GetStationName(int id, vector<Station>& stations, StationIndex& index);
+void BFS(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, int fromID, string options);
+void ShowPath(ostream& out, PathEngine& paths, vector<Station>& stations, StationIndex& index, int fromID, int toID, string options);
+void ShowNear(ostream& out, SpatialIndex& spatial, vector<Station>& stations, double latitude, double longitude, int k);
+void ShowWithin(ostream& out, SpatialIndex& spatial, vector<Station>& stations, StationIndex& index, int id, double meters);
+void ShowODMatrix(ostream& out, Graph& DivvyGraph, vector<Station>& stations, StationIndex& index, SpatialIndex& spatial,
+	ODMatrix& od, string options);
@@ -0,0 +1,913 @@
+//
+// server.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <algorithm>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <afunix.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+#include "ingest.h"
+#include "queries.h"
+#include "server.h"
+#include "tripfiles.h"
+
+using namespace std;
+
+
+const intptr_t NoSocket = -1;				// no socket (INVALID_SOCKET on Windows)
+const size_t   MaxLineBytes = 1 << 20;		// a client sending a longer line is dropped
+
+// the query commands a client may run: the ones that only read the
+// dataset.  Anything else is refused, od among them as it writes files.
+static const char *const ServedQueries[] = { "info", "trips", "arrivals", "bfs", "path", "near", "within",
+	"debug", "durations", "riders", "ages", "moves", "rebalancing", "imbalance", "components", "component",
+	"stats", "exit" };
+
+
+//
+// the directory of a file, made absolute with . and .. and links
+// resolved, so two spellings of one directory compare equal
+//
+static filesystem::path DirectoryOf(const string& filename)
+{
+	filesystem::path dir = filesystem::path(filename).parent_path();
+	error_code       ec;
+
+	filesystem::path resolved = filesystem::weakly_canonical(dir.empty() ? filesystem::path(".") : dir, ec);
+	return ec ? filesystem::path() : resolved;
+}
+
+
+//
+// sets up the socket library once: Winsock on Windows; elsewhere a
+// client going away must not kill the process with SIGPIPE
+//
+static void StartSockets()
+{
+	static once_flag started;
+
+	call_once(started, []() {
+#ifdef _WIN32
+		WSADATA data;
+		WSAStartup(MAKEWORD(2, 2), &data);
+#else
+		signal(SIGPIPE, SIG_IGN);
+#endif
+	});
+}
+
+
+// closes a socket
+static void CloseSocket(intptr_t s)
+{
+#ifdef _WIN32
+	closesocket((SOCKET)s);
+#else
+	close((int)s);
+#endif
+}
+
+
+//
+// sends all n bytes, returns false if the connection is gone
+//
+static bool SendAll(intptr_t s, const char *p, size_t n)
+{
+	while (n > 0) {
+		int chunk = (int)min(n, (size_t)(1 << 30));
+#ifdef MSG_NOSIGNAL
+		int sent = (int)send(s, p, chunk, MSG_NOSIGNAL);
+#else
+		int sent = (int)send(s, p, chunk, 0);
+#endif
+		if (sent <= 0)
+			return false;
+
+		p += sent;
+		n -= sent;
+	}
+
+	return true;
+}
+
+
+// receives up to n bytes, 0 once the peer has closed, < 0 on error
+static int Receive(intptr_t s, char *p, size_t n)
+{
+	return (int)recv(s, p, (int)n, 0);
+}
+
+
+// true if the last failed socket call was interrupted by a signal
+static bool Interrupted()
+{
+#ifdef _WIN32
+	return WSAGetLastError() == WSAEINTR;
+#else
+	return errno == EINTR;
+#endif
+}
+
+
+// true if the last failed socket call would have had to block
+static bool WouldBlock()
+{
+#ifdef _WIN32
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+	return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+
+// makes sends and receives on the socket return rather than wait
+static void SetNonBlocking(intptr_t s)
+{
+#ifdef _WIN32
+	u_long one = 1;
+	ioctlsocket((SOCKET)s, FIONBIO, &one);
+#else
+	fcntl((int)s, F_SETFL, fcntl((int)s, F_GETFL, 0) | O_NONBLOCK);
+#endif
+}
+
+
+//
+// sends what it can of the n bytes without waiting; returns the # of
+// bytes sent, 0 if the socket cannot take any now, or -1 if the
+// connection is gone
+//
+static int SendSome(intptr_t s, const char *p, size_t n)
+{
+	int chunk = (int)min(n, (size_t)(1 << 30));
+#ifdef MSG_NOSIGNAL
+	int sent = (int)send(s, p, chunk, MSG_NOSIGNAL);
+#else
+	int sent = (int)send(s, p, chunk, 0);
+#endif
+	if (sent < 0)
+		return WouldBlock() ? 0 : -1;
+
+	return sent;
+}
+
+
+//
+// OpenSocket:
+//
+// Listens on (or, unless listening, connects to) the given address: a
+// Unix domain socket path, "unix:path" or any path with a /, else a
+// TCP port on 127.0.0.1.  A stale socket file in the way of a listener
+// is removed first.  Hands back the socket path if any; returns the
+// socket, or NoSocket on failure.
+//
+static intptr_t OpenSocket(string address, bool listening, string& socketPath)
+{
+	StartSockets();
+	socketPath.clear();
+
+	if (address.compare(0, 5, "unix:") == 0)
+		socketPath = address.substr(5);
+	else if (address.find('/') != string::npos)
+		socketPath = address;
+
+	intptr_t s;
+	int      result;
+
+	if (!socketPath.empty()) {
+		sockaddr_un where;
+		memset(&where, 0, sizeof(where));
+		where.sun_family = AF_UNIX;
+
+		if (socketPath.size() >= sizeof(where.sun_path))
+			return NoSocket;
+		memcpy(where.sun_path, socketPath.c_str(), socketPath.size());
+
+		s = (intptr_t)socket(AF_UNIX, SOCK_STREAM, 0);
+		if (s == NoSocket)
+			return NoSocket;
+
+		if (listening) {
+			error_code ec;
+			if (filesystem::is_socket(socketPath, ec))
+				filesystem::remove(socketPath, ec);
+
+			result = ::bind(s, (sockaddr *)&where, sizeof(where));
+		}
+		else {
+			result = connect(s, (sockaddr *)&where, sizeof(where));
+		}
+	}
+	else {
+		char *end;
+		long  port = strtol(address.c_str(), &end, 10);
+		if (address.empty() || *end != '\0' || port < 1 || port > 65535)
+			return NoSocket;
+
+		sockaddr_in where;
+		memset(&where, 0, sizeof(where));
+		where.sin_family = AF_INET;
+		where.sin_port = htons((uint16_t)port);
+		where.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+		s = (intptr_t)socket(AF_INET, SOCK_STREAM, 0);
+		if (s == NoSocket)
+			return NoSocket;
+
+		// answers go out as soon as they are written
+		int one = 1;
+		setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char *)&one, sizeof(one));
+
+		if (listening) {
+			setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char *)&one, sizeof(one));
+			result = ::bind(s, (sockaddr *)&where, sizeof(where));
+		}
+		else {
+			result = connect(s, (sockaddr *)&where, sizeof(where));
+		}
+	}
+
+	if (result != 0 || (listening && listen(s, 64) != 0)) {
+		CloseSocket(s);
+		return NoSocket;
+	}
+
+	return s;
+}
+
+
+//
+// a connected pair of sockets: what is sent on one can be received on
+// the other.  Windows has no socketpair(), so there the pair goes
+// through a loopback TCP connection.
+//
+static bool SocketPair(intptr_t& first, intptr_t& second)
+{
+#ifdef _WIN32
+	StartSockets();
+
+	SOCKET listener = socket(AF_INET, SOCK_STREAM, 0);
+	if (listener == INVALID_SOCKET)
+		return false;
+
+	sockaddr_in where;
+	int         size = sizeof(where);
+	memset(&where, 0, sizeof(where));
+	where.sin_family = AF_INET;
+	where.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	SOCKET a = INVALID_SOCKET, b = INVALID_SOCKET;
+	if (::bind(listener, (sockaddr *)&where, sizeof(where)) == 0
+		&& getsockname(listener, (sockaddr *)&where, &size) == 0
+		&& listen(listener, 1) == 0
+		&& (a = socket(AF_INET, SOCK_STREAM, 0)) != INVALID_SOCKET
+		&& connect(a, (sockaddr *)&where, sizeof(where)) == 0)
+		b = accept(listener, NULL, NULL);
+
+	closesocket(listener);
+	if (b == INVALID_SOCKET) {
+		if (a != INVALID_SOCKET)
+			closesocket(a);
+		return false;
+	}
+
+	first = (intptr_t)a;
+	second = (intptr_t)b;
+	return true;
+#else
+	int pair[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0)
+		return false;
+
+	first = pair[0];
+	second = pair[1];
+	return true;
+#endif
+}
+
+
+// waits for one of the sockets to be ready
+static int Poll(vector<pollfd>& fds)
+{
+#ifdef _WIN32
+	return WSAPoll(fds.data(), (ULONG)fds.size(), -1);
+#else
+	return poll(fds.data(), (nfds_t)fds.size(), -1);
+#endif
+}
+
+
+//
+// Constructor:
+//
+Dataset::Dataset()
+	: DivvyGraph(1000)
+{
+	this->Generation = 1;
+}
+
+
+//
+// Load:
+//
+// Builds the dataset from the given files as main does: the graph from
+// its snapshot if up to date, the trip store on first use.  A server
+// never writes a snapshot.  Returns false if a file cannot be opened.
+//
+bool Dataset::Load(string stationsFilename, const vector<string>& tripsFilenames)
+{
+	if (!ifstream(stationsFilename).good() || tripsFilenames.empty())
+		return false;
+
+	for (const string& filename : tripsFilenames) {
+		if (!ifstream(filename).good())
+			return false;
+	}
+
+	// room for every station, even in larger files
+	this->DivvyGraph = Graph(max(1000, CountRecords(stationsFilename)));
+	LoadGraph(this->DivvyGraph, this->Stations, this->Index, this->Buckets, stationsFilename, tripsFilenames, false);
+	this->Trips.SetSource(tripsFilenames);
+	this->Spatial.Build(this->Stations);
+	this->TripsFilenames = tripsFilenames;
+
+	return !this->Stations.empty();
+}
+
+
+//
+// Constructor:
+//
+// Serves the given dataset, built from the given stations file, with
+// numWorkers workers once Listen() and Run() are called.
+//
+QueryServer::QueryServer(string stationsFilename, shared_ptr<Dataset> data, int numWorkers)
+	: StationsFilename(stationsFilename)
+{
+	this->NumWorkers = max(numWorkers, 1);
+	this->Listener = NoSocket;
+	this->WakeSend = this->WakeRecv = NoSocket;
+	this->Stopping = false;
+	this->Reloading = false;
+	this->ReloadFailed = false;
+
+	for (const string& filename : data->TripsFilenames) {
+		filesystem::path dir = DirectoryOf(filename);
+		if (!dir.empty() && find(this->TripsDirs.begin(), this->TripsDirs.end(), dir) == this->TripsDirs.end())
+			this->TripsDirs.push_back(dir);
+	}
+
+	data->Paths.resize(this->NumWorkers);
+	atomic_store(&this->Current, data);
+}
+
+
+//
+// Destructor:
+//
+// Waits for a running reload, then closes the sockets.
+//
+QueryServer::~QueryServer()
+{
+	if (this->Reloader.joinable())
+		this->Reloader.join();
+
+	for (intptr_t s : { this->Listener, this->WakeSend, this->WakeRecv }) {
+		if (s != NoSocket)
+			CloseSocket(s);
+	}
+
+	if (!this->SocketPath.empty()) {
+		error_code ec;
+		filesystem::remove(this->SocketPath, ec);
+	}
+}
+
+
+//
+// starts listening on the given address (see OpenSocket()), returns
+// false if it cannot
+//
+bool QueryServer::Listen(string address)
+{
+	this->Listener = OpenSocket(address, true, this->SocketPath);
+	if (this->Listener == NoSocket)
+		return false;
+
+	return SocketPair(this->WakeSend, this->WakeRecv);
+}
+
+
+// the dataset the queries currently run against
+shared_ptr<Dataset> QueryServer::GetCurrent()
+{
+	return atomic_load(&this->Current);
+}
+
+
+//
+// Run:
+//
+// Starts the workers and runs the I/O loop until a client sends
+// shutdown: accepts connections, reads from the idle ones, and hands a
+// connection holding a whole line to the workers.  Connections coming
+// back from the workers send their answers, waiting for the socket to
+// take them if need be, and are then polled again, or closed.
+//
+void QueryServer::Run()
+{
+	vector<thread> workers;
+	for (int w = 0; w < this->NumWorkers; w++)
+		workers.push_back(thread(&QueryServer::Worker, this, w));
+
+	vector<Connection *> idle;		// connections waiting for input
+	vector<Connection *> sending;	// connections waiting to send their answers
+	vector<pollfd>       fds;
+	char                 buffer[64 * 1024];
+
+	// sends what the socket takes of the connection's answers; false
+	// if the connection is gone
+	auto flush = [&](Connection *c) {
+		while (c->Sent < c->Output.size()) {
+			int sent = SendSome(c->Socket, c->Output.data() + c->Sent, c->Output.size() - c->Sent);
+			if (sent < 0)
+				return false;
+			if (sent == 0)
+				return true;
+			c->Sent += sent;
+		}
+
+		c->Output.clear();
+		c->Sent = 0;
+		return true;
+	};
+
+	// sends the connection's answers, then hands it to the workers if it
+	// has a whole line, or is closing (its whole lines are still
+	// answered); else keeps it idle.  Answers the socket does not take
+	// yet wait in sending, and so do the lines after them.
+	auto dispatch = [&](Connection *c) {
+		if (!flush(c)) {
+			CloseSocket(c->Socket);
+			delete c;
+		}
+		else if (!c->Output.empty()) {
+			sending.push_back(c);
+		}
+		else if (c->Input.find('\n') != string::npos) {
+			{
+				lock_guard<mutex> guard(this->Lock);
+				this->Work.push_back(c);
+			}
+			this->Ready.notify_one();
+		}
+		else if (c->Closing) {
+			CloseSocket(c->Socket);
+			delete c;
+		}
+		else {
+			idle.push_back(c);
+		}
+	};
+
+	while (!this->Stopping)
+	{
+		fds.clear();
+		fds.push_back(pollfd{ (decltype(pollfd::fd))this->Listener, POLLIN, 0 });
+		fds.push_back(pollfd{ (decltype(pollfd::fd))this->WakeRecv, POLLIN, 0 });
+		for (Connection *c : idle)
+			fds.push_back(pollfd{ (decltype(pollfd::fd))c->Socket, POLLIN, 0 });
+		for (Connection *c : sending)
+			fds.push_back(pollfd{ (decltype(pollfd::fd))c->Socket, POLLOUT, 0 });
+
+		if (Poll(fds) < 0) {
+			if (Interrupted())
+				continue;
+
+			// anything else will not go away by polling again
+			cerr << "**Error: unable to poll the connections, stopping the server" << endl;
+			{
+				lock_guard<mutex> guard(this->Lock);
+				this->Stopping = true;
+			}
+			break;
+		}
+
+		vector<Connection *> ready;		// connections to dispatch again
+		vector<Connection *> polled;
+
+		// input on the idle connections
+		polled.swap(idle);
+		for (size_t i = 0; i < polled.size(); i++) {
+			Connection *c = polled[i];
+
+			if (fds[i + 2].revents == 0) {
+				idle.push_back(c);
+				continue;
+			}
+
+			int n = Receive(c->Socket, buffer, sizeof(buffer));
+			if (n < 0 && WouldBlock()) {
+				idle.push_back(c);
+				continue;
+			}
+
+			if (n <= 0 || c->Input.size() + n > MaxLineBytes)
+				c->Closing = true;
+			else
+				c->Input.append(buffer, n);
+
+			ready.push_back(c);
+		}
+
+		// room for the answers of the sending ones
+		size_t first = 2 + polled.size();
+		polled.clear();
+		polled.swap(sending);
+		for (size_t i = 0; i < polled.size(); i++) {
+			if (fds[first + i].revents == 0)
+				sending.push_back(polled[i]);
+			else
+				ready.push_back(polled[i]);
+		}
+
+		// connections the workers are done with
+		if (fds[1].revents != 0) {
+			Receive(this->WakeRecv, buffer, sizeof(buffer));
+
+			lock_guard<mutex> guard(this->Lock);
+			ready.insert(ready.end(), this->Returned.begin(), this->Returned.end());
+			this->Returned.clear();
+		}
+
+		for (Connection *c : ready)
+			dispatch(c);
+
+		// new clients
+		if (fds[0].revents != 0) {
+			intptr_t s = (intptr_t)accept(this->Listener, NULL, NULL);
+			if (s != NoSocket) {
+				int one = 1;
+				setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char *)&one, sizeof(one));
+				SetNonBlocking(s);
+
+				Connection *c = new Connection;
+				c->Socket = s;
+				idle.push_back(c);
+			}
+		}
+	}
+
+	// stop the workers, they finish the connections they hold
+	this->Ready.notify_all();
+	for (thread& w : workers)
+		w.join();
+
+	// the answers still to send (shutdown's own among them) get one try
+	sending.insert(sending.end(), this->Returned.begin(), this->Returned.end());
+	for (Connection *c : sending)
+		flush(c);
+
+	for (vector<Connection *> *connections : { &idle, &sending }) {
+		for (Connection *c : *connections) {
+			CloseSocket(c->Socket);
+			delete c;
+		}
+	}
+	for (Connection *c : this->Work) {
+		CloseSocket(c->Socket);
+		delete c;
+	}
+	this->Work.clear();
+	this->Returned.clear();
+}
+
+
+//
+// worker w: serves connections from the queue until the server stops
+//
+void QueryServer::Worker(int w)
+{
+	while (true)
+	{
+		Connection *c;
+		{
+			unique_lock<mutex> guard(this->Lock);
+			this->Ready.wait(guard, [this]() { return this->Stopping || !this->Work.empty(); });
+
+			if (this->Stopping)
+				return;
+
+			c = this->Work.front();
+			this->Work.pop_front();
+		}
+
+		this->Serve(c, w);
+
+		{
+			lock_guard<mutex> guard(this->Lock);
+			this->Returned.push_back(c);
+		}
+		this->Wake();
+	}
+}
+
+
+//
+// answers every whole line the connection holds, in order, appending
+// the answers to its output and leaving any partial line for later
+//
+void QueryServer::Serve(Connection *c, int w)
+{
+	size_t start = 0, end;
+
+	while ((end = c->Input.find('\n', start)) != string::npos)
+	{
+		string line = c->Input.substr(start, end - start);
+		start = end + 1;
+
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+
+		bool   closing = false;
+		string output = this->Command(line, w, closing);
+
+		// the lines after exit go unanswered
+		if (closing) {
+			c->Closing = true;
+			c->Input.clear();
+			return;
+		}
+
+		// for the I/O thread to send
+		c->Output += to_string(output.size()) + "\n";
+		c->Output += output;
+	}
+
+	c->Input.erase(0, start);
+}
+
+
+//
+// runs one command line for worker w, returns its output; closing is
+// set if the client is done (exit)
+//
+string QueryServer::Command(const string& line, int w, bool& closing)
+{
+	stringstream ss(line);
+	string       cmd;
+
+	ss >> cmd;
+
+	// the server's own commands
+	if (cmd == "status")
+	{
+		shared_ptr<Dataset> data = this->GetCurrent();
+		ostringstream       out;
+
+		out << "** generation " << data->Generation << ": " << data->TripsFilenames.size() << " trips files, "
+			<< data->DivvyGraph.GetNumVertices() << " vertices, " << data->DivvyGraph.GetNumEdges() << " edges" << endl;
+		for (string& filename : data->TripsFilenames)
+			out << "   " << filename << endl;
+		if (this->Reloading)
+			out << "** reload running" << endl;
+		else if (this->ReloadFailed)
+			out << "** last reload failed" << endl;
+
+		return out.str();
+	}
+
+	if (cmd == "reload")
+	{
+		string spec;
+		getline(ss, spec);
+
+		return this->Reload(spec);
+	}
+
+	if (cmd == "shutdown")
+	{
+		{
+			lock_guard<mutex> guard(this->Lock);
+			this->Stopping = true;
+		}
+		this->Ready.notify_all();
+		this->Wake();
+
+		return "** shutting down\n";
+	}
+
+	// a query, if one the server runs
+	if (!cmd.empty() && find(begin(ServedQueries), end(ServedQueries), cmd) == end(ServedQueries))
+		return "** " + cmd + " is not available from the server\n";
+
+	// against the dataset published right now
+	shared_ptr<Dataset> data = this->GetCurrent();
+	ostringstream       out;
+
+	if (data->Paths[w] == nullptr)
+		data->Paths[w] = make_unique<PathEngine>(data->DivvyGraph, data->Stations, data->Index);
+
+	if (!RunQuery(out, line, data->DivvyGraph, data->Stations, data->Index, data->Buckets, data->Trips,
+		data->OD, *data->Paths[w], data->Spatial))
+		closing = true;
+
+	return out.str();
+}
+
+
+//
+// Reload:
+//
+// Starts building a fresh dataset from the given trips files (the
+// current ones if none) on a thread of its own, and publishes it once
+// built; the queries keep running against the current one meanwhile.
+// One reload at a time.  Every entry of the spec must lie in one of the
+// directories of the trips files given to --serve, checked before any
+// pattern is expanded, so a client cannot have the server read (or list)
+// anything else.  Returns the answer for the client.
+//
+string QueryServer::Reload(string spec)
+{
+	if (this->Reloading.exchange(true))
+		return "** a reload is already running\n";
+
+	vector<string> filenames;
+	spec.erase(0, spec.find_first_not_of(" \t"));
+	if (spec.find_first_not_of(" \t\r") == string::npos)
+		filenames = this->GetCurrent()->TripsFilenames;
+	else {
+		// each comma-separated entry, checked as ExpandTripFiles() splits them
+		size_t start = 0;
+		while (start <= spec.size()) {
+			size_t comma = spec.find(',', start);
+			if (comma == string::npos)
+				comma = spec.size();
+			string entry = spec.substr(start, comma - start);
+			size_t first = entry.find_first_not_of(" \t\r");
+			size_t last = entry.find_last_not_of(" \t\r");
+			start = comma + 1;
+			if (first == string::npos)
+				continue;
+
+			filesystem::path dir = DirectoryOf(entry.substr(first, last - first + 1));
+			if (dir.empty() || find(this->TripsDirs.begin(), this->TripsDirs.end(), dir) == this->TripsDirs.end()) {
+				this->Reloading = false;
+				return "**Error: reload only reads trips files in the directories given to --serve\n";
+			}
+		}
+		filenames = ExpandTripFiles(spec);
+	}
+
+	if (filenames.empty()) {
+		this->Reloading = false;
+		return "**Error: no trips files match '" + spec + "'\n";
+	}
+
+	// the last reload is over, as Reloading was clear
+	if (this->Reloader.joinable())
+		this->Reloader.join();
+
+	this->Reloader = thread([this, filenames]() {
+		shared_ptr<Dataset> fresh = make_shared<Dataset>();
+
+		if (fresh->Load(this->StationsFilename, filenames)) {
+			fresh->Generation = this->GetCurrent()->Generation + 1;
+			fresh->Paths.resize(this->NumWorkers);
+
+			atomic_store(&this->Current, fresh);
+			this->ReloadFailed = false;
+		}
+		else {
+			this->ReloadFailed = true;
+		}
+
+		this->Reloading = false;
+	});
+
+	return "** reloading from " + to_string(filenames.size()) + " trips files\n";
+}
+
+
+//
+// wakes up the I/O thread
+//
+void QueryServer::Wake()
+{
+	char byte = 0;
+	SendAll(this->WakeSend, &byte, 1);
+}
+
+
+//
+// RunClient:
+//
+// Sends each command line of in (blank lines skipped) to the server at
+// the given address and writes its answer to out, until exit or the end
+// of in.  Returns 0, or 1 if the server cannot be reached or hangs up.
+//
+int RunClient(string address, istream& in, ostream& out)
+{
+	string   socketPath;
+	intptr_t s = OpenSocket(address, false, socketPath);
+
+	if (s == NoSocket) {
+		cerr << "**Error: unable to connect to '" << address << "'" << endl;
+		return 1;
+	}
+
+	string line, received;
+	char   buffer[64 * 1024];
+	int    status = 0;
+
+	// receives until received holds at least n bytes
+	auto fill = [&](size_t n) {
+		while (received.size() < n) {
+			int got = Receive(s, buffer, sizeof(buffer));
+			if (got <= 0)
+				return false;
+			received.append(buffer, got);
+		}
+		return true;
+	};
+
+	while (getline(in, line))
+	{
+		if (line.find_first_not_of(" \t\r") == string::npos)
+			continue;
+
+		stringstream ss(line);
+		string       cmd;
+		ss >> cmd;
+
+		if (cmd == "exit")
+			break;
+
+		line += '\n';
+		if (!SendAll(s, line.data(), line.size())) {
+			status = 1;
+			break;
+		}
+
+		// "<# of bytes>\n", then the bytes
+		size_t newline;
+		while ((newline = received.find('\n')) == string::npos) {
+			if (!fill(received.size() + 1))
+				break;
+		}
+		if (newline == string::npos) {
+			status = 1;
+			break;
+		}
+
+		size_t size = (size_t)strtoull(received.c_str(), nullptr, 10);
+		received.erase(0, newline + 1);
+
+		if (!fill(size)) {
+			status = 1;
+			break;
+		}
+
+		out.write(received.data(), size);
+		out.flush();
+		received.erase(0, size);
+
+		if (cmd == "shutdown")
+			break;
+	}
+
+	if (status != 0)
+		cerr << "**Error: the server at '" << address << "' hung up" << endl;
+
+	CloseSocket(s);
+	return status;
+}
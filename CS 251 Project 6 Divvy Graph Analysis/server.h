@@ -0,0 +1,170 @@
+//
+// server.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <filesystem>
+
+#include "graph.h"
+#include "odmatrix.h"
+#include "path.h"
+#include "spatial.h"
+#include "station.h"
+#include "timebuckets.h"
+#include "tripstore.h"
+
+using namespace std;
+
+
+//
+// Query server: serves the query commands to any # of clients at once
+// over a Unix domain socket or a localhost TCP port, and reloads the
+// trips in the background without holding up the queries.
+//
+// Protocol: the client sends command lines; the server answers each
+// with its output, sent as "<# of bytes>\n" and then the bytes, in the
+// order of the commands.  The query commands that only read are served
+// (see ServedQueries in server.cpp; od, which writes files, is not).
+// Besides them the server takes
+//   status				the loaded trips files and graph
+//   reload [trips]		rebuild from the trips files (the same as now, or
+//						new ones as in ExpandTripFiles()) in the background;
+//						only files in the directories of the trips files
+//						given to --serve are read, and no snapshot is written
+//   shutdown			stop the server
+// and exit, which closes the connection.
+//
+// An address is a socket path ("unix:/tmp/divvy.sock", or any path with
+// a /) or a TCP port on 127.0.0.1 ("7777").
+//
+
+
+// function prototypes
+int RunClient(string address, istream& in, ostream& out);
+
+
+//
+// Dataset class
+//
+// Everything the queries read: the graph, the stations and their
+// indexes, the time buckets, the trip store and the OD matrix.  Built
+// once by Load() and then only read (the trip store and the OD matrix
+// fill themselves in on first use), so any # of queries may run against
+// it at once.  Each server worker has a path engine of its own over it.
+// Never moves, the indexes point into it.
+//
+class Dataset
+{
+public:
+	Graph           DivvyGraph;			// frozen graph
+	vector<Station> Stations;
+	StationIndex    Index;
+	TimeBuckets     Buckets;
+	TripStore       Trips;				// every trip field, read on demand
+	ODMatrix        OD;					// dense trip counts, built on demand
+	SpatialIndex    Spatial;
+	vector<string>  TripsFilenames;		// trips files it was built from
+	int             Generation;			// 1 for the first load, +1 per reload
+
+	vector<unique_ptr<PathEngine>> Paths;	// per server worker, made on its first query
+
+	Dataset();
+
+	Dataset(const Dataset&) = delete;
+	Dataset& operator=(const Dataset&) = delete;
+
+	// public function prototypes
+	bool Load(string stationsFilename, const vector<string>& tripsFilenames);
+};
+
+
+//
+// QueryServer class
+//
+// A fixed pool of worker threads runs the commands, while one I/O
+// thread (the one calling Run()) accepts connections and waits for
+// their next command lines.  A connection is handed to a worker once it
+// holds a whole line and comes back once the worker has answered every
+// line it holds, so its answers stay in order while different clients
+// are served in parallel, and an idle client ties up no worker.  The
+// workers leave the answers with the connection; the I/O thread sends
+// them without blocking, so a client slow to read ties up no worker
+// either, and gets no more lines answered until it has read them.
+//
+// The dataset is published RCU-style: a query grabs the current one
+// through an atomic shared_ptr load and keeps it until it is done; a
+// reload builds a fresh one on a thread of its own and swaps it in with
+// an atomic store.  Queries never wait for a reload, and the old dataset
+// is freed when the last query using it finishes.
+//
+class QueryServer
+{
+private:
+
+	// Connection class: a client, its unanswered input and unsent answers
+	class Connection
+	{
+	public:
+		intptr_t Socket;				// client socket, non-blocking
+		string   Input;					// received, not yet answered
+		string   Output;				// answered, not yet (all) sent
+		size_t   Sent = 0;				// bytes of Output sent so far
+		bool     Closing = false;		// drop once answered (exit, or the client hung up)
+	};
+
+	string                  StationsFilename;	// stations file, the same for every reload
+	vector<filesystem::path> TripsDirs;			// directories of the served trips files, the only ones reloaded from
+	shared_ptr<Dataset>     Current;			// published dataset, only accessed atomically
+	int                     NumWorkers;			// size of the worker pool
+
+	intptr_t                Listener;			// listening socket
+	intptr_t                WakeSend, WakeRecv;	// socket pair to wake up the I/O thread
+	string                  SocketPath;			// path of a Unix domain socket, to unlink at the end
+
+	mutex                   Lock;				// guards the queues below
+	condition_variable      Ready;				// work queued, or stopping
+	deque<Connection *>     Work;				// connections holding whole lines
+	vector<Connection *>    Returned;			// connections the workers are done with
+
+	atomic<bool>            Stopping;			// set by shutdown
+	atomic<bool>            Reloading;			// a reload is running
+	atomic<bool>            ReloadFailed;		// the last reload could not load the files
+	thread                  Reloader;			// the running or last reload
+
+	// private function prototypes
+	void Worker(int w);
+	void Serve(Connection *c, int w);
+	string Command(const string& line, int w, bool& closing);
+	string Reload(string spec);
+	void Wake();
+
+public:
+	QueryServer(string stationsFilename, shared_ptr<Dataset> data, int numWorkers);
+	~QueryServer();
+
+	QueryServer(const QueryServer&) = delete;
+	QueryServer& operator=(const QueryServer&) = delete;
+
+	// public function prototypes
+	bool Listen(string address);
+	void Run();
+	shared_ptr<Dataset> GetCurrent();
+};
@@ -0,0 +1,337 @@
+//
+// snapshot.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#include <fstream>
+#include <cstring>
+#include <filesystem>
+
+#include "csvscanner.h"
+#include "snapshot.h"
+
+using namespace std;
+
+
+//
+// FNV-1a, continued from h
+//
+static uint64_t Checksum(uint64_t h, const char *p, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		h ^= (unsigned char)p[i];
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+
+//
+// rounds n up to a multiple of 8
+//
+static size_t Align8(size_t n)
+{
+	return (n + 7) & ~(size_t)7;
+}
+
+
+//
+// grabs size and write time of the given file, false if it is missing
+//
+static bool FileStamp(const string& filename, uint64_t& size, int64_t& time)
+{
+	error_code ec;
+
+	size = (uint64_t)filesystem::file_size(filename, ec);
+	if (ec)
+		return false;
+
+	time = (int64_t)filesystem::last_write_time(filename, ec).time_since_epoch().count();
+	return !ec;
+}
+
+
+//
+// grabs the total size of the given trips files and a stamp of their
+// names, sizes and write times, in order; false if one is missing
+//
+static bool TripsStamp(const vector<string>& filenames, uint64_t& size, uint64_t& stamp)
+{
+	size = 0;
+	stamp = 14695981039346656037ull;
+
+	for (const string& filename : filenames) {
+		uint64_t fileSize;
+		int64_t  fileTime;
+
+		if (!FileStamp(filename, fileSize, fileTime))
+			return false;
+
+		size += fileSize;
+		stamp = Checksum(stamp, filename.c_str(), filename.size() + 1);
+		stamp = Checksum(stamp, (const char *)&fileSize, sizeof(fileSize));
+		stamp = Checksum(stamp, (const char *)&fileTime, sizeof(fileTime));
+	}
+
+	return true;
+}
+
+
+//
+// Writes the frozen graph, the stations and the time buckets to the
+// given file, returns true if successful.
+//
+bool SaveSnapshot(string filename, Graph& G, vector<Station>& stations, TimeBuckets& buckets,
+	string stationsFilename, const vector<string>& tripsFilenames)
+{
+	if (!G.IsFrozen() || buckets.IsEmpty())
+		return false;
+
+	SnapshotHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.Magic, "DIVVYSNP", 8);
+	header.Version = SnapshotVersion;
+
+	if (!FileStamp(stationsFilename, header.StationsSize, header.StationsTime)
+		|| !TripsStamp(tripsFilenames, header.TripsSize, header.TripsStamp))
+		return false;
+	header.NumTripsFiles = (uint32_t)tripsFilenames.size();
+
+	//
+	// intern the names: every vertex name, in vertex order, then the
+	// names of stations that did not make it into the graph
+	//
+	int numVertices = G.GetNumVertices();
+	vector<string>      names;
+	vector<SnapshotStation> records;
+
+	for (int v = 0; v < numVertices; v++)
+		names.push_back(string(G.GetName(v)));
+
+	for (Station& s : stations) {
+		SnapshotStation r;
+		r.ID = s.ID;
+		r.Capacity = s.Capacity;
+		r.Reserved = 0;
+		r.Latitude = s.Latitude;
+		r.Longitude = s.Longitude;
+		r.NameIndex = G.FindVertexByName(s.Name);
+
+		if (r.NameIndex == -1) {
+			r.NameIndex = (int32_t)names.size();
+			names.push_back(s.Name);
+		}
+
+		records.push_back(r);
+	}
+
+	vector<uint32_t> nameOffsets;
+	string           nameBytes;
+	for (string& n : names) {
+		nameOffsets.push_back((uint32_t)nameBytes.size());
+		nameBytes += n;
+	}
+	nameOffsets.push_back((uint32_t)nameBytes.size());
+	nameBytes.resize(Align8(nameBytes.size()), '\0');
+
+	// the file holds 32-bit destinations and weights, whatever the
+	// graph's own widths
+	const vector<int>& offsets = G.GetOffsets();
+	vector<int32_t>    dests(G.GetDests().begin(), G.GetDests().end());
+	vector<int32_t>    weights(G.GetWeights().begin(), G.GetWeights().end());
+
+	header.NumStations = (uint32_t)records.size();
+	header.NumNames = (uint32_t)names.size();
+	header.NumVertices = (uint32_t)numVertices;
+	header.NumEdges = (uint32_t)dests.size();
+	header.NameBytes = (uint32_t)nameBytes.size();
+	header.NumBucketEntries = (uint32_t)buckets.GetBuckets().size();
+
+	//
+	// assemble the payload, each section padded to 8 bytes
+	//
+	string payload;
+	auto append = [&payload](const void *p, size_t n) {
+		payload.append((const char *)p, n);
+		payload.resize(Align8(payload.size()), '\0');
+	};
+
+	append(records.data(), records.size() * sizeof(SnapshotStation));
+	append(nameOffsets.data(), nameOffsets.size() * sizeof(uint32_t));
+	append(nameBytes.data(), nameBytes.size());
+	append(offsets.data(), offsets.size() * sizeof(int));
+	append(dests.data(), dests.size() * sizeof(int));
+	append(weights.data(), weights.size() * sizeof(int));
+	append(buckets.GetEdgeStart().data(), buckets.GetEdgeStart().size() * sizeof(int));
+	append(buckets.GetBuckets().data(), buckets.GetBuckets().size() * sizeof(uint8_t));
+	append(buckets.GetCounts().data(), buckets.GetCounts().size() * sizeof(int));
+
+	header.Checksum = Checksum(14695981039346656037ull, payload.data(), payload.size());
+
+	// write to a temporary file first, so a reader never sees half a snapshot
+	string tmpFilename = filename + ".tmp";
+	{
+		ofstream output(tmpFilename, ios::binary | ios::trunc);
+		if (!output.good())
+			return false;
+
+		output.write((const char *)&header, sizeof(header));
+		output.write(payload.data(), payload.size());
+		if (!output.good())
+			return false;
+	}
+
+	error_code ec;
+	filesystem::rename(tmpFilename, filename, ec);
+	if (ec) {
+		filesystem::remove(tmpFilename, ec);
+		return false;
+	}
+
+	return true;
+}
+
+
+//
+// Loads a snapshot into the given graph, which must have no vertices
+// yet, filling the stations vector and the time buckets and building
+// the station index.
+// Returns false, leaving the graph, stations and time buckets untouched,
+// if the file is missing, corrupt, of another version, or was built from
+// different stations / trips files.
+//
+bool LoadSnapshot(string filename, Graph& G, vector<Station>& stations, StationIndex& index,
+	TimeBuckets& buckets, string stationsFilename, const vector<string>& tripsFilenames)
+{
+	MappedFile file;
+	if (!file.Open(filename) || file.Size() < sizeof(SnapshotHeader))
+		return false;
+
+	SnapshotHeader header;
+	memcpy(&header, file.Data(), sizeof(header));
+
+	if (memcmp(header.Magic, "DIVVYSNP", 8) != 0 || header.Version != SnapshotVersion)
+		return false;
+
+	// must be built from the same input files
+	uint64_t size, stamp;
+	int64_t  time;
+	if (!FileStamp(stationsFilename, size, time) || size != header.StationsSize || time != header.StationsTime)
+		return false;
+	if (header.NumTripsFiles != tripsFilenames.size() || !TripsStamp(tripsFilenames, size, stamp)
+		|| size != header.TripsSize || stamp != header.TripsStamp)
+		return false;
+
+	// graph must be empty and large enough
+	if (G.GetNumVertices() != 0 || (int)header.NumVertices > G.GetCapacity()
+		|| header.NumVertices > header.NumNames)
+		return false;
+
+	//
+	// locate the sections and verify the total size
+	//
+	const char *payload = file.Data() + sizeof(header);
+	size_t      payloadSize = file.Size() - sizeof(header);
+	size_t      pos = 0;
+
+	size_t stationsAt = pos;
+	pos += Align8((size_t)header.NumStations * sizeof(SnapshotStation));
+	size_t nameOffsetsAt = pos;
+	pos += Align8(((size_t)header.NumNames + 1) * sizeof(uint32_t));
+	size_t nameBytesAt = pos;
+	pos += Align8(header.NameBytes);
+	size_t offsetsAt = pos;
+	pos += Align8(((size_t)header.NumVertices + 1) * sizeof(int));
+	size_t destsAt = pos;
+	pos += Align8((size_t)header.NumEdges * sizeof(int));
+	size_t weightsAt = pos;
+	pos += Align8((size_t)header.NumEdges * sizeof(int));
+	size_t bucketStartAt = pos;
+	pos += Align8(((size_t)header.NumEdges + 1) * sizeof(int));
+	size_t bucketsAt = pos;
+	pos += Align8((size_t)header.NumBucketEntries * sizeof(uint8_t));
+	size_t bucketCountsAt = pos;
+	pos += Align8((size_t)header.NumBucketEntries * sizeof(int));
+
+	if (pos != payloadSize)
+		return false;
+
+	if (Checksum(14695981039346656037ull, payload, payloadSize) != header.Checksum)
+		return false;
+
+	//
+	// the mapping is page aligned and every section is 8-byte aligned,
+	// so the arrays can be used in place
+	//
+	const SnapshotStation *records = (const SnapshotStation *)(payload + stationsAt);
+	const uint32_t        *nameOffsets = (const uint32_t *)(payload + nameOffsetsAt);
+	const char            *nameBytes = payload + nameBytesAt;
+
+	for (uint32_t i = 0; i < header.NumNames; i++) {
+		if (nameOffsets[i] > nameOffsets[i + 1] || nameOffsets[i + 1] > header.NameBytes)
+			return false;
+	}
+	for (uint32_t i = 0; i < header.NumStations; i++) {
+		if (records[i].NameIndex < 0 || (uint32_t)records[i].NameIndex >= header.NumNames)
+			return false;
+	}
+
+	// CSR arrays must be consistent before the graph is touched
+	const int *offsets = (const int *)(payload + offsetsAt);
+	const int *dests = (const int *)(payload + destsAt);
+
+	if (offsets[0] != 0 || offsets[header.NumVertices] != (int)header.NumEdges)
+		return false;
+	for (uint32_t v = 0; v < header.NumVertices; v++) {
+		if (offsets[v] > offsets[v + 1])
+			return false;
+	}
+	for (uint32_t e = 0; e < header.NumEdges; e++) {
+		if (dests[e] < 0 || dests[e] >= (int)header.NumVertices)
+			return false;
+	}
+
+	// and so must the time buckets, kept aside until the graph loads too
+	const int  *bucketStart = (const int *)(payload + bucketStartAt);
+	TimeBuckets loaded;
+
+	if (bucketStart[header.NumEdges] != (int)header.NumBucketEntries)
+		return false;
+	if (!loaded.Load((int)header.NumEdges, bucketStart, (const uint8_t *)(payload + bucketsAt),
+		(const int *)(payload + bucketCountsAt)))
+		return false;
+
+	auto name = [&](uint32_t i) {
+		return string_view(nameBytes + nameOffsets[i], nameOffsets[i + 1] - nameOffsets[i]);
+	};
+
+	// vertices, in the original vertex order, then the edges; a graph
+	// that will not take them is emptied again
+	bool added = true;
+	for (uint32_t v = 0; v < header.NumVertices && added; v++)
+		added = G.AddVertex(name(v));
+
+	if (!added || !G.LoadFrozen(offsets, dests, (const int *)(payload + weightsAt), (int)header.NumEdges)) {
+		G = Graph(G.GetCapacity());
+		return false;
+	}
+
+	// station table, already sorted by id
+	stations.clear();
+	stations.reserve(header.NumStations);
+	for (uint32_t i = 0; i < header.NumStations; i++) {
+		const SnapshotStation& r = records[i];
+		stations.push_back(Station(string(name(r.NameIndex)), r.ID, r.Latitude, r.Longitude, r.Capacity));
+	}
+
+	index.Build(stations, G);
+	buckets = move(loaded);
+	return true;
+}
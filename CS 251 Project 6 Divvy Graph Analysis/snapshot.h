@@ -0,0 +1,83 @@
+//
+// snapshot.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "graph.h"
+#include "station.h"
+#include "timebuckets.h"
+
+using namespace std;
+
+
+//
+// Binary snapshot of the frozen graph and the station table.
+//
+// Layout (native byte order, every section 8-byte aligned):
+//   SnapshotHeader
+//   SnapshotStation[NumStations]		sorted by station id
+//   uint32_t NameOffsets[NumNames+1]	into the name bytes
+//   char     NameBytes[NameBytes]		vertex names first, in vertex order
+//   int32_t  Offsets[NumVertices+1]	CSR arrays, as in Graph::Freeze()
+//   int32_t  Dests[NumEdges]
+//   int32_t  Weights[NumEdges]
+//   int32_t  BucketStart[NumEdges+1]	time buckets, as in TimeBuckets
+//   uint8_t  Buckets[NumBucketEntries]
+//   int32_t  BucketCounts[NumBucketEntries]
+//
+// Checksum is FNV-1a over everything after the header.  The header
+// also records the size and write time of the stations file and a
+// stamp of the trips files the snapshot was built from, so a stale
+// snapshot is rejected.
+//
+const uint32_t SnapshotVersion = 3;
+
+class SnapshotHeader
+{
+public:
+	char     Magic[8];				// "DIVVYSNP"
+	uint32_t Version;				// SnapshotVersion
+	uint32_t NumStations;			// # of station records
+	uint32_t NumNames;				// # of interned names
+	uint32_t NumVertices;			// # of graph vertices
+	uint32_t NumEdges;				// # of graph edges
+	uint32_t NameBytes;				// # of bytes of name text
+	uint32_t NumBucketEntries;		// # of time bucket entries
+	uint32_t NumTripsFiles;			// # of source trips files
+	uint64_t StationsSize;			// source stations file size
+	int64_t  StationsTime;			// source stations file write time
+	uint64_t TripsSize;				// total size of the source trips files
+	uint64_t TripsStamp;			// FNV-1a of their names, sizes and write times
+	uint64_t Checksum;				// FNV-1a of the payload
+};
+
+class SnapshotStation
+{
+public:
+	int32_t ID;						// Divvy station id
+	int32_t Capacity;				// # of docks
+	int32_t NameIndex;				// index into the names
+	int32_t Reserved;				// padding, 0
+	double  Latitude;
+	double  Longitude;
+};
+
+
+// function prototypes
+bool SaveSnapshot(string filename, Graph& G, vector<Station>& stations, TimeBuckets& buckets,
+	string stationsFilename, const vector<string>& tripsFilenames);
+bool LoadSnapshot(string filename, Graph& G, vector<Station>& stations, StationIndex& index,
+	TimeBuckets& buckets, string stationsFilename, const vector<string>& tripsFilenames);
@@ -0,0 +1,254 @@
+//
+// spatial.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#include <algorithm>
+#include <cmath>
+
+#include "geo.h"
+#include "spatial.h"
+
+using namespace std;
+
+
+// meters per degree of latitude
+static const double MetersPerDegree = EarthRadiusMeters * DegreesToRadians;
+
+
+// orders hits by distance, then by position for ties
+static bool CloserHit(const SpatialIndex::Hit& a, const SpatialIndex::Hit& b)
+{
+	if (a.Meters != b.Meters)
+		return a.Meters < b.Meters;
+	return a.Pos < b.Pos;
+}
+
+
+//
+// Constructor:
+//
+SpatialIndex::SpatialIndex(double cellMeters)
+{
+	this->CellMeters = cellMeters;
+	this->MinLat = this->MinLon = 0.0;
+	this->CellLat = this->CellLon = 1.0;
+	this->CellLonMeters = cellMeters;
+	this->Rows = this->Cols = 0;
+}
+
+
+// grid row / column of a coordinate, may fall outside the grid
+int SpatialIndex::RowOf(double lat)
+{
+	double r = floor((lat - this->MinLat) / this->CellLat);
+	return (int)max(-1e6, min(r, 1e6));
+}
+
+int SpatialIndex::ColOf(double lon)
+{
+	double c = floor((lon - this->MinLon) / this->CellLon);
+	return (int)max(-1e6, min(c, 1e6));
+}
+
+
+//
+// buckets every station into its grid cell
+//
+void SpatialIndex::Build(vector<Station>& stations)
+{
+	int n = (int)stations.size();
+
+	this->Latitude.resize(n);
+	this->Longitude.resize(n);
+	this->CellStart.clear();
+	this->CellItems.clear();
+	this->Rows = this->Cols = 0;
+
+	if (n == 0)
+		return;
+
+	double maxLat = stations[0].Latitude, maxLon = stations[0].Longitude;
+	this->MinLat = maxLat;
+	this->MinLon = maxLon;
+
+	for (int i = 0; i < n; i++) {
+		this->Latitude[i] = stations[i].Latitude;
+		this->Longitude[i] = stations[i].Longitude;
+
+		this->MinLat = min(this->MinLat, this->Latitude[i]);
+		this->MinLon = min(this->MinLon, this->Longitude[i]);
+		maxLat = max(maxLat, this->Latitude[i]);
+		maxLon = max(maxLon, this->Longitude[i]);
+	}
+
+	// cells are square in meters at the middle latitude; the width
+	// shrinks towards the pole, keep the narrowest for distance bounds
+	double midCos = cos((this->MinLat + maxLat) / 2 * DegreesToRadians);
+	double minCos = min(cos(this->MinLat * DegreesToRadians), cos(maxLat * DegreesToRadians));
+
+	// outlying stations could blow the grid up, so coarsen the cells
+	// until there are at most a few per station
+	for (;;) {
+		this->CellLat = this->CellMeters / MetersPerDegree;
+		this->CellLon = this->CellLat / max(midCos, 0.01);
+		this->CellLonMeters = this->CellLon * MetersPerDegree * max(minCos, 0.01);
+
+		this->Rows = this->RowOf(maxLat) + 1;
+		this->Cols = this->ColOf(maxLon) + 1;
+
+		if ((long long)this->Rows * this->Cols <= max(4LL * n, 1024LL))
+			break;
+		this->CellMeters *= 2;
+	}
+
+	// count per cell, prefix sum, then scatter
+	vector<int> cellOf(n);
+	this->CellStart.assign(this->Rows * this->Cols + 1, 0);
+
+	for (int i = 0; i < n; i++) {
+		cellOf[i] = this->RowOf(this->Latitude[i]) * this->Cols + this->ColOf(this->Longitude[i]);
+		this->CellStart[cellOf[i] + 1]++;
+	}
+	for (int c = 0; c < this->Rows * this->Cols; c++)
+		this->CellStart[c + 1] += this->CellStart[c];
+
+	vector<int> fill(this->CellStart.begin(), this->CellStart.end() - 1);
+	this->CellItems.resize(n);
+	for (int i = 0; i < n; i++)
+		this->CellItems[fill[cellOf[i]]++] = i;
+}
+
+
+//
+// Nearest:
+//
+// Finds the k stations closest to (lat, lon), closest first.  Scans
+// rings of cells around the query cell (the nearest cell of the grid
+// if the point is outside it) and stops once no unscanned cell can
+// hold anything closer than the k-th best so far, or the whole grid
+// has been scanned.
+//
+void SpatialIndex::Nearest(double lat, double lon, int k, vector<Hit>& hits)
+{
+	hits.clear();
+	if (k <= 0 || this->CellItems.empty())
+		return;
+
+	int r0 = min(max(this->RowOf(lat), 0), this->Rows - 1);
+	int c0 = min(max(this->ColOf(lon), 0), this->Cols - 1);
+
+	// rings needed to cover the whole grid from the query cell
+	int maxRing = max(max(r0, this->Rows - 1 - r0), max(c0, this->Cols - 1 - c0));
+
+	// meters any cell in ring R+1 or beyond is at least away from the
+	// query cell; a small margin covers the flat-grid approximation
+	double ringMeters = 0.9 * min(this->CellMeters, this->CellLonMeters);
+
+	// meters from the point to the grid's bounding box, 0 inside it.
+	// Seen from outside, a cell beyond ring R is both that far and ring
+	// R away from the nearest point of the box, which the box being
+	// convex combines as sqrt(outside^2 + (R * ringMeters)^2)
+	double halfLon = this->Cols * this->CellLon / 2;
+	double midLon = this->MinLon + halfLon;
+	double nearLat = min(max(lat, this->MinLat), this->MinLat + this->Rows * this->CellLat);
+	double nearLon = midLon + min(max(remainder(lon - midLon, 360.0), -halfLon), halfLon);
+	double outside = 0.9 * Haversine(lat, lon, nearLat, nearLon);
+
+	// max-heap on distance holding the best k
+	auto scan = [&](int r, int c) {
+		if (r < 0 || r >= this->Rows || c < 0 || c >= this->Cols)
+			return;
+
+		int cell = r * this->Cols + c;
+		for (int i = this->CellStart[cell]; i < this->CellStart[cell + 1]; i++) {
+			int    pos = this->CellItems[i];
+			Hit    h{ pos, Haversine(lat, lon, this->Latitude[pos], this->Longitude[pos]) };
+
+			if ((int)hits.size() < k) {
+				hits.push_back(h);
+				push_heap(hits.begin(), hits.end(), CloserHit);
+			}
+			else if (CloserHit(h, hits.front())) {
+				pop_heap(hits.begin(), hits.end(), CloserHit);
+				hits.back() = h;
+				push_heap(hits.begin(), hits.end(), CloserHit);
+			}
+		}
+	};
+
+	for (int ring = 0; ring <= maxRing; ring++) {
+		if (ring == 0) {
+			scan(r0, c0);
+		}
+		else {
+			// the part of the ring within the grid: top and bottom rows,
+			// then the sides
+			int cLo = max(c0 - ring, 0), cHi = min(c0 + ring, this->Cols - 1);
+			int rLo = max(r0 - ring + 1, 0), rHi = min(r0 + ring - 1, this->Rows - 1);
+
+			for (int c = cLo; c <= cHi; c++) {
+				scan(r0 - ring, c);
+				scan(r0 + ring, c);
+			}
+			for (int r = rLo; r <= rHi; r++) {
+				scan(r, c0 - ring);
+				scan(r, c0 + ring);
+			}
+		}
+
+		// everything unscanned is at least this far away
+		double beyond = hypot(outside, ring * ringMeters);
+		if ((int)hits.size() == k && hits.front().Meters <= beyond)
+			break;
+	}
+
+	sort_heap(hits.begin(), hits.end(), CloserHit);
+}
+
+
+//
+// Within:
+//
+// Finds every station at most meters away from (lat, lon), closest
+// first.
+//
+void SpatialIndex::Within(double lat, double lon, double meters, vector<Hit>& hits)
+{
+	hits.clear();
+	if (meters < 0 || this->CellItems.empty())
+		return;
+
+	// bounding box of the circle, in degrees
+	double dLat = meters / MetersPerDegree;
+	double farCos = cos(min(fabs(lat) + dLat, 89.0) * DegreesToRadians);
+	double dLon = dLat / max(farCos, 0.01);
+
+	int rLo = max(this->RowOf(lat - dLat), 0);
+	int rHi = min(this->RowOf(lat + dLat), this->Rows - 1);
+	int cLo = max(this->ColOf(lon - dLon), 0);
+	int cHi = min(this->ColOf(lon + dLon), this->Cols - 1);
+
+	for (int r = rLo; r <= rHi; r++) {
+		for (int c = cLo; c <= cHi; c++) {
+			int cell = r * this->Cols + c;
+
+			for (int i = this->CellStart[cell]; i < this->CellStart[cell + 1]; i++) {
+				int    pos = this->CellItems[i];
+				double d = Haversine(lat, lon, this->Latitude[pos], this->Longitude[pos]);
+
+				if (d <= meters)
+					hits.push_back(Hit{ pos, d });
+			}
+		}
+	}
+
+	sort(hits.begin(), hits.end(), CloserHit);
+}
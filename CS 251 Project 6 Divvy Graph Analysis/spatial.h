@@ -0,0 +1,66 @@
+//
+// spatial.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <vector>
+
+#include "station.h"
+
+using namespace std;
+
+
+//
+// SpatialIndex class
+//
+// Uniform latitude / longitude grid over the stations, cells roughly
+// CellMeters on a side (coarser if the stations are far apart).  Each
+// cell lists the positions (in the sorted stations vector) of the
+// stations inside it, stored CSR-style.  Distances are great-circle
+// meters.
+//
+class SpatialIndex
+{
+public:
+
+	// Hit class
+	class Hit
+	{
+	public:
+		int    Pos;					// position in the stations vector
+		double Meters;				// distance from the query point
+	};
+
+private:
+	double         CellMeters;		// nominal cell size
+	double         MinLat, MinLon;	// south-west corner of the grid
+	double         CellLat;			// cell height in degrees
+	double         CellLon;			// cell width in degrees
+	double         CellLonMeters;	// narrowest cell width in meters
+	int            Rows, Cols;		// grid size
+	vector<int>    CellStart;		// stations of cell c are
+	vector<int>    CellItems;		// CellItems[CellStart[c] .. CellStart[c+1])
+	vector<double> Latitude;		// coordinates by station position
+	vector<double> Longitude;
+
+	// private function prototypes
+	int RowOf(double lat);
+	int ColOf(double lon);
+
+public:
+	SpatialIndex(double cellMeters = 500.0);
+
+	// public function prototypes
+	void Build(vector<Station>& stations);
+	void Nearest(double lat, double lon, int k, vector<Hit>& hits);
+	void Within(double lat, double lon, double meters, vector<Hit>& hits);
+};
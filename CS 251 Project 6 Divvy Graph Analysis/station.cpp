@@ -0,0 +1,97 @@
+//
+// station.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#include "station.h"
+
+using namespace std;
+
+
+//
+// Constructor:
+//
+StationIndex::StationIndex()
+{
+	this->G = nullptr;
+}
+
+
+//
+// builds the index over the given stations, which must already
+// be added to the graph as vertices.  When several stations share
+// a vertex, the first one in the vector wins, just like a linear
+// search over the vector would.
+//
+void StationIndex::Build(vector<Station>& stations, Graph& G)
+{
+	int n = (int)stations.size();
+
+	this->G = &G;
+	this->ByID.Clear();
+	this->ByID.Reserve(n);
+	this->VertexStation.assign(G.GetNumVertices(), -1);
+	this->StationVertex.assign(n, -1);
+
+	for (int i = 0; i < n; i++) {
+		this->ByID.Insert(stations[i].ID, i);
+
+		int v = G.FindVertexByName(stations[i].Name);
+		this->StationVertex[i] = v;
+
+		if (v != -1 && this->VertexStation[v] == -1)
+			this->VertexStation[v] = i;
+	}
+}
+
+
+//
+// returns position of the station with the given id, -1 if not found
+//
+int StationIndex::Find(int id)
+{
+	return this->ByID.Find(id);
+}
+
+
+//
+// returns position of the station stored as vertex v, -1 if not found
+//
+int StationIndex::FindByVertex(int v)
+{
+	if (v < 0 || v >= (int)this->VertexStation.size())
+		return -1;
+
+	return this->VertexStation[v];
+}
+
+
+//
+// returns position of the station with the given name, -1 if not found
+//
+int StationIndex::FindByName(string_view name)
+{
+	if (this->G == nullptr)
+		return -1;
+
+	return this->FindByVertex(this->G->FindVertexByName(name));
+}
+
+
+//
+// returns vertex # of the station at the given position, -1 if none
+//
+int StationIndex::VertexOf(int pos)
+{
+	if (pos < 0 || pos >= (int)this->StationVertex.size())
+		return -1;
+
+	return this->StationVertex[pos];
+}
@@ -0,0 +1,80 @@
+//
+// station.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "graph.h"
+#include "hashindex.h"
+
+using namespace std;
+
+
+//
+// Defines a Divvy Station:
+//
+class Station
+{
+public:
+	string Name;
+	int    ID;
+	double Latitude;
+	double Longitude;
+	int    Capacity;
+
+	// constructor
+	Station(string name, int id, double latitude, double longitude, int capacity)
+	{
+		Name = name;
+		ID = id;
+		Latitude = latitude;
+		Longitude = longitude;
+		Capacity = capacity;
+	}
+
+	// getter for station ID
+	int GetID() {
+		return this->ID;
+	}
+
+};
+
+
+//
+// StationIndex class
+//
+// Maps Divvy station ids and graph vertices to positions in the
+// (sorted) vector of stations.  Built once after the stations are
+// input; station names are resolved through the graph's own name
+// index, so both sides share a single name -> vertex map.
+//
+class StationIndex
+{
+private:
+	Graph          *G;				// graph holding the station vertices
+	HashIndex<int>  ByID;			// station id -> position in stations
+	vector<int>     VertexStation;	// vertex # -> position in stations
+	vector<int>     StationVertex;	// position in stations -> vertex #
+
+public:
+	StationIndex();
+
+	// public function prototypes
+	void Build(vector<Station>& stations, Graph& G);
+	int Find(int id);
+	int FindByVertex(int v);
+	int FindByName(string_view name);
+	int VertexOf(int pos);
+};
@@ -0,0 +1,296 @@
+//
+// stats.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#include <fstream>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdio>
+#include <cstdint>
+
+#include "stats.h"
+
+using namespace std;
+
+
+#ifdef DIVVY_STATS
+
+// names of the operations, in Stat order
+static const char *StatNames[] = {
+	"InputStations",
+	"ProcessTrips.parse",
+	"ProcessTrips.insert",
+	"Graph.FindVertexByName",
+	"Graph.AddEdge",
+	"Graph.BFS",
+	"Graph.BuildComponents",
+	"cmd.info",
+	"cmd.arrivals",
+	"cmd.trips",
+	"cmd.bfs",
+	"cmd.path",
+	"cmd.near",
+	"cmd.within",
+	"cmd.debug",
+	"cmd.durations",
+	"cmd.riders",
+	"cmd.ages",
+	"cmd.moves",
+	"cmd.rebalancing",
+	"cmd.components",
+	"cmd.component",
+	"cmd.od",
+	"cmd.imbalance",
+	"TripStore.Load",
+	"TripStore.DetectMoves",
+	"Archive.Decode",
+	"ODMatrix.Build",
+	"TripStore.DockFlows"
+};
+
+static const int NumStats = (int)Stat::NumStats;
+static const int NumBuckets = 48;	// bucket b holds [2^b, 2^(b+1)) ns, bucket 0 also 0 ns
+
+
+//
+// StatsBlock class
+//
+// One thread's counters.  Only the owning thread writes them, with
+// relaxed load + store, so the hot path has no locked instructions;
+// readers may sum them up at any time.
+//
+class StatsBlock
+{
+public:
+	atomic<uint64_t> Calls[NumStats];
+	atomic<uint64_t> Items[NumStats];
+	atomic<uint64_t> TotalNs[NumStats];
+	atomic<uint64_t> MaxNs[NumStats];
+	atomic<uint64_t> Histogram[NumStats][NumBuckets];
+
+	StatsBlock()
+	{
+		for (int s = 0; s < NumStats; s++) {
+			this->Calls[s] = this->Items[s] = this->TotalNs[s] = this->MaxNs[s] = 0;
+			for (int b = 0; b < NumBuckets; b++)
+				this->Histogram[s][b] = 0;
+		}
+	}
+};
+
+
+//
+// every block ever handed out; a thread gives its block back when it
+// exits and the next new thread carries on counting in it
+//
+static mutex                          BlocksLock;
+static vector<unique_ptr<StatsBlock>> Blocks;
+static vector<StatsBlock *>           FreeBlocks;
+
+
+// a thread's hold on its block
+class StatsHolder
+{
+public:
+	StatsBlock *Block = nullptr;
+
+	~StatsHolder()
+	{
+		if (this->Block != nullptr) {
+			lock_guard<mutex> guard(BlocksLock);
+			FreeBlocks.push_back(this->Block);
+		}
+	}
+};
+
+static thread_local StatsHolder Holder;
+
+
+// the calling thread's block
+static StatsBlock& LocalBlock()
+{
+	if (Holder.Block == nullptr) {
+		lock_guard<mutex> guard(BlocksLock);
+
+		if (!FreeBlocks.empty()) {
+			Holder.Block = FreeBlocks.back();
+			FreeBlocks.pop_back();
+		}
+		else {
+			Blocks.push_back(unique_ptr<StatsBlock>(new StatsBlock()));
+			Holder.Block = Blocks.back().get();
+		}
+	}
+
+	return *Holder.Block;
+}
+
+
+// adds n to a counter only this thread writes
+static inline void Bump(atomic<uint64_t>& counter, uint64_t n)
+{
+	counter.store(counter.load(memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+
+//
+// records one call of an operation that took the given time and
+// handled the given # of items
+//
+void RecordStat(Stat which, long long nanoseconds, long long items)
+{
+	StatsBlock& block = LocalBlock();
+	int         s = (int)which;
+	uint64_t    ns = (nanoseconds > 0) ? (uint64_t)nanoseconds : 0;
+
+	int bucket = 0;
+	for (uint64_t n = ns; n > 1 && bucket < NumBuckets - 1; n >>= 1)
+		bucket++;
+
+	Bump(block.Calls[s], 1);
+	Bump(block.Items[s], (uint64_t)items);
+	Bump(block.TotalNs[s], ns);
+	Bump(block.Histogram[s][bucket], 1);
+	if (ns > block.MaxNs[s].load(memory_order_relaxed))
+		block.MaxNs[s].store(ns, memory_order_relaxed);
+}
+
+
+//
+// Totals class
+//
+// One operation's counters summed over the threads.
+//
+class Totals
+{
+public:
+	uint64_t Calls = 0, Items = 0, TotalNs = 0, MaxNs = 0;
+	uint64_t Histogram[NumBuckets] = { 0 };
+
+	// upper end of the bucket holding the p-th fraction of the calls, in ns
+	uint64_t Percentile(double p)
+	{
+		uint64_t seen = 0;
+		for (int b = 0; b < NumBuckets; b++) {
+			seen += this->Histogram[b];
+			if (seen > 0 && seen >= p * this->Calls)
+				return min((uint64_t)2 << b, this->MaxNs);
+		}
+		return this->MaxNs;
+	}
+};
+
+
+// sums every thread's counters of operation s
+static Totals Sum(int s)
+{
+	lock_guard<mutex> guard(BlocksLock);
+	Totals            t;
+
+	for (auto& block : Blocks) {
+		t.Calls += block->Calls[s].load(memory_order_relaxed);
+		t.Items += block->Items[s].load(memory_order_relaxed);
+		t.TotalNs += block->TotalNs[s].load(memory_order_relaxed);
+		t.MaxNs = max(t.MaxNs, (uint64_t)block->MaxNs[s].load(memory_order_relaxed));
+		for (int b = 0; b < NumBuckets; b++)
+			t.Histogram[b] += block->Histogram[s][b].load(memory_order_relaxed);
+	}
+
+	return t;
+}
+
+
+//
+// ReportStats:
+//
+// Displays a line per operation called so far: calls, items, total
+// time, mean and percentile latencies (percentiles are bucket bounds,
+// so within a factor of 2).
+//
+void ReportStats(ostream& out)
+{
+	char line[256];
+
+	snprintf(line, sizeof(line), "%-24s %10s %12s %12s %10s %10s %10s %10s",
+		"Operation", "calls", "items", "total ms", "mean us", "p50 us", "p99 us", "max us");
+	out << line << '\n';
+
+	for (int s = 0; s < NumStats; s++) {
+		Totals t = Sum(s);
+		if (t.Calls == 0)
+			continue;
+
+		snprintf(line, sizeof(line), "%-24s %10llu %12llu %12.2f %10.2f %10.2f %10.2f %10.2f",
+			StatNames[s], (unsigned long long)t.Calls, (unsigned long long)t.Items, t.TotalNs / 1e6,
+			t.TotalNs / 1e3 / t.Calls, t.Percentile(0.50) / 1e3, t.Percentile(0.99) / 1e3, t.MaxNs / 1e3);
+		out << line << '\n';
+	}
+}
+
+
+//
+// DumpStats:
+//
+// Writes every operation's counters and histogram to the given file as
+// JSON, returns false if the file cannot be written.
+//
+bool DumpStats(string filename)
+{
+	ofstream file(filename);
+	if (!file.good())
+		return false;
+
+	file << "{\"buckets\": \"power-of-two ns, bucket b = [2^b, 2^(b+1))\", \"stats\": [";
+
+	for (int s = 0; s < NumStats; s++) {
+		Totals t = Sum(s);
+
+		file << (s > 0 ? "," : "") << "\n  {\"name\": \"" << StatNames[s] << "\""
+			<< ", \"calls\": " << t.Calls
+			<< ", \"items\": " << t.Items
+			<< ", \"total_ns\": " << t.TotalNs
+			<< ", \"max_ns\": " << t.MaxNs
+			<< ", \"p50_ns\": " << t.Percentile(0.50)
+			<< ", \"p90_ns\": " << t.Percentile(0.90)
+			<< ", \"p99_ns\": " << t.Percentile(0.99)
+			<< ", \"histogram\": [";
+
+		for (int b = 0; b < NumBuckets; b++)
+			file << (b > 0 ? ", " : "") << t.Histogram[b];
+		file << "]}";
+	}
+
+	file << "\n]}\n";
+	return file.good();
+}
+
+#else
+
+//
+// without DIVVY_STATS nothing is recorded
+//
+void RecordStat(Stat, long long, long long)
+{
+}
+
+void ReportStats(ostream& out)
+{
+	out << "**Statistics are not compiled in (build with DIVVY_STATS)..." << '\n';
+}
+
+bool DumpStats(string)
+{
+	return false;
+}
+
+#endif
@@ -0,0 +1,121 @@
+//
+// stats.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <chrono>
+
+using namespace std;
+
+
+//
+// Instrumentation of the hot paths: per instrumented operation a call
+// count, an item count, total and max time, and a latency histogram
+// with power-of-two nanosecond buckets.  Every thread records into its
+// own block of counters, so recording never contends; the blocks are
+// summed up when reported.
+//
+// Only built with DIVVY_STATS defined (the Debug configurations); without
+// it the STAT_ macros expand to nothing and the stats command just says
+// so.  Usage:
+//
+//   STAT_TIMER(timer, Stat::InputStations);	// times to the end of the scope
+//   STAT_ITEMS(timer, n);						// # of items the call handled
+//
+
+
+//
+// instrumented operations, see StatNames in stats.cpp
+//
+enum class Stat
+{
+	InputStations,					// reading the stations file
+	TripsParse,						// one trips file line: fields, ids, time bucket
+	TripsInsert,					// one graph update, or one bulk insert of the counted routes
+	FindVertexByName,				// Graph primitives
+	AddEdge,
+	BFS,
+	BuildComponents,
+	Info,							// command handlers
+	Arrivals,
+	Trips,
+	BFSCommand,
+	Path,
+	Near,
+	Within,
+	Debug,
+	Durations,
+	Riders,
+	Ages,
+	Moves,
+	Rebalancing,
+	Components,
+	Component,
+	OD,
+	Imbalance,
+	TripStoreLoad,					// reading every trip field into the trip store
+	DetectMoves,					// bike trajectories and rebalancing moves
+	ArchiveDecode,					// one trip archive block
+	ODMatrixBuild,					// the dense OD matrix from the frozen graph
+	DockFlows,						// trips per station and hour, over the trip store
+	NumStats
+};
+
+
+// function prototypes
+void RecordStat(Stat which, long long nanoseconds, long long items);
+void ReportStats(ostream& out);
+bool DumpStats(string filename);
+
+
+//
+// StatTimer class
+//
+// Records the time from its construction to its destruction.
+//
+class StatTimer
+{
+private:
+	Stat      Which;				// operation timed
+	long long Items;				// # of items, 1 unless set
+	chrono::steady_clock::time_point Start;
+
+public:
+	StatTimer(Stat which)
+	{
+		this->Which = which;
+		this->Items = 1;
+		this->Start = chrono::steady_clock::now();
+	}
+
+	~StatTimer()
+	{
+		auto elapsed = chrono::steady_clock::now() - this->Start;
+		RecordStat(this->Which, chrono::duration_cast<chrono::nanoseconds>(elapsed).count(), this->Items);
+	}
+
+	void SetItems(long long items)
+	{
+		this->Items = items;
+	}
+};
+
+
+#ifdef DIVVY_STATS
+#define STAT_TIMER(name, which)		StatTimer name(which)
+#define STAT_ITEMS(name, n)			name.SetItems(n)
+#else
+#define STAT_TIMER(name, which)
+#define STAT_ITEMS(name, n)
+#endif
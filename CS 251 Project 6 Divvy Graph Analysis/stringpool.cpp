@@ -0,0 +1,144 @@
+//
+// stringpool.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#include <cstring>
+
+#include "stringpool.h"
+
+using namespace std;
+
+
+//
+// Constructor:
+//
+StringPool::StringPool()
+{
+	this->Used = BlockSize;
+}
+
+
+//
+// Move constructor:
+//
+// The blocks change hands, so the views into them stay valid.
+//
+StringPool::StringPool(StringPool&& other) noexcept
+	: Blocks(move(other.Blocks)),
+	Strings(move(other.Strings)),
+	Index(move(other.Index))
+{
+	this->Used = other.Used;
+
+	other.Blocks.clear();
+	other.Strings.clear();
+	other.Index = HashIndex<string_view>();
+	other.Used = BlockSize;
+}
+
+
+//
+// Move assignment:
+//
+StringPool& StringPool::operator=(StringPool&& other) noexcept
+{
+	if (this != &other) {
+		this->Blocks = move(other.Blocks);
+		this->Strings = move(other.Strings);
+		this->Index = move(other.Index);
+		this->Used = other.Used;
+
+		other.Blocks.clear();
+		other.Strings.clear();
+		other.Index = HashIndex<string_view>();
+		other.Used = BlockSize;
+	}
+
+	return *this;
+}
+
+
+//
+// returns the id of s, interning a copy of it if it is new
+//
+int StringPool::Intern(string_view s)
+{
+	int id = this->Index.Find(s);
+	if (id != -1)
+		return id;
+
+	// copy into the last block, or a new one if it does not fit; a
+	// string longer than a block gets a block of its own, slotted in
+	// before the last block while that one still has room
+	char *text;
+	if (s.size() > BlockSize) {
+		auto at = this->Blocks.end();
+		if (this->Used < BlockSize)
+			at--;
+		text = this->Blocks.insert(at, unique_ptr<char[]>(new char[s.size()]))->get();
+	}
+	else {
+		if (this->Used + s.size() > BlockSize) {
+			this->Blocks.push_back(unique_ptr<char[]>(new char[BlockSize]));
+			this->Used = 0;
+		}
+		text = this->Blocks.back().get() + this->Used;
+		this->Used += s.size();
+	}
+
+	if (!s.empty())
+		memcpy(text, s.data(), s.size());
+
+	string_view copy(text, s.size());
+	id = (int)this->Strings.size();
+
+	this->Strings.push_back(copy);
+	this->Index.Insert(copy, id);
+	return id;
+}
+
+
+//
+// returns the id of s, or -1 if it was never interned
+//
+int StringPool::Find(string_view s) const
+{
+	return this->Index.Find(s);
+}
+
+
+//
+// returns the interned string with the given id, empty if none
+//
+string_view StringPool::Get(int id) const
+{
+	if (id < 0 || id >= (int)this->Strings.size())
+		return string_view();
+
+	return this->Strings[id];
+}
+
+
+// # of interned strings
+int StringPool::Size() const
+{
+	return (int)this->Strings.size();
+}
+
+
+//
+// makes room for n strings without rehashing the index
+//
+void StringPool::Reserve(int n)
+{
+	this->Strings.reserve(n);
+	this->Index.Reserve(n);
+}
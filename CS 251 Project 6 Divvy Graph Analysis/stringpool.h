@@ -0,0 +1,58 @@
+//
+// stringpool.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+#include "hashindex.h"
+
+using namespace std;
+
+
+//
+// StringPool class
+//
+// Interns strings: each distinct string is stored once, in blocks of
+// characters that never move, and gets a dense id (0, 1, .. in the
+// order of first interning).  Lookups take a string_view and never
+// allocate; the views handed back stay valid as long as the pool,
+// even when the pool is moved.  Move-only.
+//
+class StringPool
+{
+private:
+	static const size_t BlockSize = 64 * 1024;	// characters per block
+
+	vector<unique_ptr<char[]>> Blocks;		// character storage
+	size_t                     Used;		// # of characters used in the last block
+	vector<string_view>        Strings;		// interned strings, by id
+	HashIndex<string_view>     Index;		// string -> id
+
+public:
+	StringPool();
+
+	StringPool(const StringPool&) = delete;
+	StringPool& operator=(const StringPool&) = delete;
+	StringPool(StringPool&& other) noexcept;
+	StringPool& operator=(StringPool&& other) noexcept;
+
+	// public function prototypes
+	int Intern(string_view s);
+	int Find(string_view s) const;
+	string_view Get(int id) const;
+	int Size() const;
+	void Reserve(int n);
+};
@@ -0,0 +1,418 @@
+//
+// timebuckets.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+#include "timebuckets.h"
+
+using namespace std;
+
+
+//
+// reads the unsigned number starting at p, advancing p; -1 if there
+// is no digit at p
+//
+static int ReadNumber(string_view s, size_t& p)
+{
+	if (p >= s.size() || s[p] < '0' || s[p] > '9')
+		return -1;
+
+	int n = 0;
+	while (p < s.size() && s[p] >= '0' && s[p] <= '9')
+		n = n * 10 + (s[p++] - '0');
+
+	return n;
+}
+
+
+//
+// day of the week, 0 = Sunday (Sakamoto's method)
+//
+static int DayOfWeek(int year, int month, int day)
+{
+	static const int t[] = { 0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4 };
+
+	if (month < 3)
+		year--;
+
+	return (year + year / 4 - year / 100 + year / 400 + t[month - 1] + day) % 7;
+}
+
+
+//
+// days from 1/1/2000 to the given date (proleptic Gregorian calendar)
+//
+static int DaysSince2000(int year, int month, int day)
+{
+	// shift the year to start in March, so the leap day comes last
+	if (month <= 2)
+		year--;
+
+	int era = year / 400;
+	int yoe = year - era * 400;
+	int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+	int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+	return era * 146097 + doe - 730425;		// 730425 = days from 3/1/0000 to 1/1/2000
+}
+
+
+//
+// parses a timestamp into its parts, returns false if it is malformed;
+// the seconds are optional
+//
+static bool ParseTimestamp(string_view timestamp, int& year, int& month, int& day, int& hour, int& minute,
+	int& second)
+{
+	size_t p = 0;
+
+	int first = ReadNumber(timestamp, p);
+	if (p >= timestamp.size())
+		return false;
+
+	if (timestamp[p] == '/') {			// month/day/year
+		month = first;
+		p++;
+		day = ReadNumber(timestamp, p);
+		if (p >= timestamp.size() || timestamp[p] != '/')
+			return false;
+		p++;
+		year = ReadNumber(timestamp, p);
+	}
+	else if (timestamp[p] == '-') {		// year-month-day
+		year = first;
+		p++;
+		month = ReadNumber(timestamp, p);
+		if (p >= timestamp.size() || timestamp[p] != '-')
+			return false;
+		p++;
+		day = ReadNumber(timestamp, p);
+	}
+	else {
+		return false;
+	}
+
+	// the hour follows the blank
+	if (p >= timestamp.size() || timestamp[p] != ' ')
+		return false;
+	p++;
+	hour = ReadNumber(timestamp, p);
+
+	// then the minutes and the seconds, if any
+	minute = second = 0;
+	if (p < timestamp.size() && timestamp[p] == ':') {
+		p++;
+		minute = ReadNumber(timestamp, p);
+		if (p < timestamp.size() && timestamp[p] == ':') {
+			p++;
+			second = ReadNumber(timestamp, p);
+		}
+	}
+
+	return year >= 1 && month >= 1 && month <= 12 && day >= 1 && day <= 31 && hour >= 0 && hour <= 23
+		&& minute >= 0 && minute <= 59 && second >= 0 && second <= 60;
+}
+
+
+//
+// ParseTimeBucket:
+//
+// Parses a trip timestamp in place, either "6/30/2016 23:35" or
+// "2016-06-30 23:35:00", and returns its time bucket, or -1 if the
+// timestamp is malformed.
+//
+int ParseTimeBucket(string_view timestamp)
+{
+	int year, month, day, hour, minute, second;
+
+	if (!ParseTimestamp(timestamp, year, month, day, hour, minute, second))
+		return -1;
+
+	return DayOfWeek(year, month, day) * 24 + hour;
+}
+
+
+//
+// same, also handing back the year and the time in seconds since
+// 1/1/2000 0:00; timestamps outside 2000-2067 count as malformed, so
+// the seconds fit in an int
+//
+int ParseTimeBucket(string_view timestamp, int& year, int& seconds)
+{
+	int month, day, hour, minute, second;
+
+	if (!ParseTimestamp(timestamp, year, month, day, hour, minute, second) || year < 2000 || year > 2067)
+		return -1;
+
+	seconds = ((DaysSince2000(year, month, day) * 24 + hour) * 60 + minute) * 60 + second;
+
+	return DayOfWeek(year, month, day) * 24 + hour;
+}
+
+
+//
+// the time bucket of a time in seconds since 1/1/2000, as handed back
+// by ParseTimeBucket(); 1/1/2000 was a Saturday
+//
+int TimeBucketOf(int seconds)
+{
+	int days = seconds / 86400;
+	int hour = seconds / 3600 % 24;
+
+	return (days + 6) % 7 * 24 + hour;
+}
+
+
+//
+// the year of a time in seconds since 1/1/2000, the inverse of
+// DaysSince2000()
+//
+int YearOf(int seconds)
+{
+	int z = seconds / 86400 + 730425;		// days since 3/1/0000
+	int era = z / 146097;
+	int doe = z - era * 146097;
+	int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	int mp = (5 * doy + 2) / 153;			// month, March = 0
+
+	return era * 400 + yoe + (mp >= 10 ? 1 : 0);
+}
+
+
+//
+// ParseBucketMask:
+//
+// Parses query options into the set of buckets they cover:
+//   hour <0-23>, day <sun..sat | 0-6>, weekday, weekend
+// Several options narrow each other down; no options cover the whole
+// week.  label describes the options for display, empty if none.
+// Returns false on an invalid option.
+//
+bool ParseBucketMask(string options, BucketMask& mask, string& label)
+{
+	static const char *dayNames[] = { "sun", "mon", "tue", "wed", "thu", "fri", "sat" };
+
+	stringstream ss(options);
+	string       word;
+
+	mask.set();
+	label.clear();
+
+	while (ss >> word) {
+		BucketMask part;
+
+		if (word == "hour") {
+			int hour;
+			if (!(ss >> hour) || hour < 0 || hour > 23)
+				return false;
+
+			for (int d = 0; d < 7; d++)
+				part.set(d * 24 + hour);
+
+			word += " " + to_string(hour);
+		}
+		else if (word == "day") {
+			string name;
+			if (!(ss >> name))
+				return false;
+
+			int day = -1;
+			if (name.size() == 1 && name[0] >= '0' && name[0] <= '6')
+				day = name[0] - '0';
+
+			for (int d = 0; d < 7 && day == -1; d++) {
+				string lower = name.substr(0, 3);
+				transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+				if (lower == dayNames[d])
+					day = d;
+			}
+			if (day == -1)
+				return false;
+
+			for (int h = 0; h < 24; h++)
+				part.set(day * 24 + h);
+
+			word += " " + name;
+		}
+		else if (word == "weekday" || word == "weekend") {
+			for (int d = 0; d < 7; d++) {
+				bool weekend = (d == 0 || d == 6);
+				if (weekend == (word == "weekend")) {
+					for (int h = 0; h < 24; h++)
+						part.set(d * 24 + h);
+				}
+			}
+		}
+		else {
+			return false;
+		}
+
+		mask &= part;
+		label += (label.empty() ? "" : ", ") + word;
+	}
+
+	return true;
+}
+
+
+//
+// adds count trips from src to dest in the given bucket
+//
+void TimeBucketCounter::Add(int src, int dest, int bucket, int count)
+{
+	long long key = ((long long)src << 36) | ((long long)dest << 8) | bucket;
+	int pos = this->Index.Find(key);
+
+	// first trip in this bucket
+	if (pos == -1) {
+		this->Index.Insert(key, (int)this->Entries.size());
+		this->Entries.push_back(Entry{ src, dest, bucket, count });
+	}
+	else {
+		this->Entries[pos].Count += count;
+	}
+}
+
+
+//
+// adds every entry counted by other into this counter
+//
+void TimeBucketCounter::Merge(TimeBucketCounter& other)
+{
+	this->Index.Reserve((int)(this->Entries.size() + other.Entries.size()));
+
+	for (Entry& e : other.Entries)
+		this->Add(e.Src, e.Dest, e.Bucket, e.Count);
+}
+
+
+// getter for the counted entries
+vector<TimeBucketCounter::Entry>& TimeBucketCounter::GetEntries()
+{
+	return this->Entries;
+}
+
+
+//
+// lays the counted entries out by edge of the frozen graph, buckets
+// ascending within each edge
+//
+void TimeBuckets::Build(Graph& G, TimeBucketCounter& counter)
+{
+	vector<TimeBucketCounter::Entry>& entries = counter.GetEntries();
+	int numEdges = G.GetNumEdges();
+
+	// edge of each entry
+	vector<int> edgeOf(entries.size());
+	this->EdgeStart.assign(numEdges + 1, 0);
+
+	for (size_t i = 0; i < entries.size(); i++) {
+		edgeOf[i] = G.FindEdge(entries[i].Src, entries[i].Dest);
+		if (edgeOf[i] != -1)
+			this->EdgeStart[edgeOf[i] + 1]++;
+	}
+	for (int e = 0; e < numEdges; e++)
+		this->EdgeStart[e + 1] += this->EdgeStart[e];
+
+	// scatter, then sort every edge's entries by bucket
+	vector<int> fill(this->EdgeStart.begin(), this->EdgeStart.end() - 1);
+	vector<pair<uint8_t, int>> items(this->EdgeStart[numEdges]);
+
+	for (size_t i = 0; i < entries.size(); i++) {
+		if (edgeOf[i] != -1)
+			items[fill[edgeOf[i]]++] = make_pair((uint8_t)entries[i].Bucket, entries[i].Count);
+	}
+
+	this->Buckets.resize(items.size());
+	this->Counts.resize(items.size());
+
+	for (int e = 0; e < numEdges; e++) {
+		sort(items.begin() + this->EdgeStart[e], items.begin() + this->EdgeStart[e + 1]);
+
+		for (int i = this->EdgeStart[e]; i < this->EdgeStart[e + 1]; i++) {
+			this->Buckets[i] = items[i].first;
+			this->Counts[i] = items[i].second;
+		}
+	}
+}
+
+
+//
+// installs ready-made arrays (e.g. from a snapshot), returns false if
+// they are inconsistent
+//
+bool TimeBuckets::Load(int numEdges, const int *edgeStart, const uint8_t *buckets, const int *counts)
+{
+	if (edgeStart[0] != 0)
+		return false;
+
+	for (int e = 0; e < numEdges; e++) {
+		if (edgeStart[e] > edgeStart[e + 1])
+			return false;
+	}
+
+	int n = edgeStart[numEdges];
+	for (int i = 0; i < n; i++) {
+		if (buckets[i] >= NumTimeBuckets)
+			return false;
+	}
+
+	this->EdgeStart.assign(edgeStart, edgeStart + numEdges + 1);
+	this->Buckets.assign(buckets, buckets + n);
+	this->Counts.assign(counts, counts + n);
+	return true;
+}
+
+
+//
+// returns the # of trips on edge e whose bucket is in mask
+//
+int TimeBuckets::Count(int e, const BucketMask& mask)
+{
+	if (e < 0 || e + 1 >= (int)this->EdgeStart.size())
+		return 0;
+
+	int count = 0;
+	for (int i = this->EdgeStart[e]; i < this->EdgeStart[e + 1]; i++) {
+		if (mask.test(this->Buckets[i]))
+			count += this->Counts[i];
+	}
+
+	return count;
+}
+
+
+// true until built or loaded
+bool TimeBuckets::IsEmpty()
+{
+	return this->EdgeStart.empty();
+}
+
+
+// getters for the arrays, for the snapshot
+const vector<int>& TimeBuckets::GetEdgeStart()
+{
+	return this->EdgeStart;
+}
+
+const vector<uint8_t>& TimeBuckets::GetBuckets()
+{
+	return this->Buckets;
+}
+
+const vector<int>& TimeBuckets::GetCounts()
+{
+	return this->Counts;
+}
@@ -0,0 +1,100 @@
+//
+// timebuckets.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <bitset>
+#include <cstdint>
+
+#include "graph.h"
+#include "hashindex.h"
+
+using namespace std;
+
+
+//
+// A trip's time bucket is its start hour of the week:
+//   bucket = day * 24 + hour,  day 0 = Sunday .. 6 = Saturday
+//
+const int NumTimeBuckets = 7 * 24;
+
+typedef bitset<NumTimeBuckets> BucketMask;		// set of buckets a query covers
+
+
+// function prototypes
+int ParseTimeBucket(string_view timestamp);
+int ParseTimeBucket(string_view timestamp, int& year, int& seconds);
+int TimeBucketOf(int seconds);
+int YearOf(int seconds);
+bool ParseBucketMask(string options, BucketMask& mask, string& label);
+
+
+//
+// TimeBucketCounter class
+//
+// Counts trips per (source, destination, bucket) during ingestion,
+// one counter per ingest worker, merged at the end.
+//
+class TimeBucketCounter
+{
+public:
+
+	// Entry class
+	class Entry
+	{
+	public:
+		int Src, Dest, Bucket, Count;
+	};
+
+private:
+	HashIndex<long long> Index;		// (src,dest,bucket) key -> position in Entries
+	vector<Entry>        Entries;	// distinct keys, in first-seen order
+
+public:
+
+	// public function prototypes
+	void Add(int src, int dest, int bucket, int count);
+	void Merge(TimeBucketCounter& other);
+	vector<Entry>& GetEntries();
+};
+
+
+//
+// TimeBuckets class
+//
+// Per-edge trip counts by time bucket, stored column-wise alongside
+// the frozen graph: the non-empty buckets of edge e (in CSR order) are
+// Buckets[EdgeStart[e] .. EdgeStart[e+1]), ascending, with their counts
+// in Counts.  An edge holds at most one entry per bucket it was used
+// in, so memory stays bounded by min(weight, 168) entries per edge.
+//
+class TimeBuckets
+{
+private:
+	vector<int>      EdgeStart;		// per edge, NumEdges+1 entries
+	vector<uint8_t>  Buckets;		// bucket of each entry
+	vector<int>      Counts;		// # of trips of each entry
+
+public:
+
+	// public function prototypes
+	void Build(Graph& G, TimeBucketCounter& counter);
+	bool Load(int numEdges, const int *edgeStart, const uint8_t *buckets, const int *counts);
+	int Count(int e, const BucketMask& mask);
+	bool IsEmpty();
+	const vector<int>& GetEdgeStart();
+	const vector<uint8_t>& GetBuckets();
+	const vector<int>& GetCounts();
+};
@@ -0,0 +1,87 @@
+//
+// tripcounter.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#include <algorithm>
+
+#include "tripcounter.h"
+
+using namespace std;
+
+
+//
+// adds count trips from src to dest
+//
+void TripCounter::Add(int src, int dest, int count)
+{
+	long long key = ((long long)src << 32) | (unsigned int)dest;
+	int pos = this->Index.Find(key);
+
+	// first trip on this route
+	if (pos == -1) {
+		this->Index.Insert(key, (int)this->Routes.size());
+		this->Routes.push_back(Route{ src, dest, count });
+	}
+	else {
+		this->Routes[pos].Count += count;
+	}
+}
+
+
+//
+// adds every route counted by other into this counter
+//
+void TripCounter::Merge(TripCounter& other)
+{
+	this->Index.Reserve((int)(this->Routes.size() + other.Routes.size()));
+
+	for (Route& r : other.Routes)
+		this->Add(r.Src, r.Dest, r.Count);
+}
+
+
+// getter for the counted routes
+vector<TripCounter::Route>& TripCounter::GetRoutes()
+{
+	return this->Routes;
+}
+
+
+//
+// inserts one edge per route into the graph, returns the # of edges
+// added.  Routes are inserted by descending destination, so every
+// insert lands at the head of the sorted adjacency list.
+//
+int TripCounter::InsertInto(Graph& G)
+{
+	sort(this->Routes.begin(), this->Routes.end(),
+		[](const Route& r1, const Route& r2) {
+
+		if (r1.Src != r2.Src)
+			return r1.Src < r2.Src;
+		return r1.Dest > r2.Dest;
+	});
+
+	int added = 0;
+	for (Route& r : this->Routes) {
+		if (G.AddEdge(r.Src, r.Dest, r.Count))
+			added++;
+	}
+
+	// positions changed, rebuild the index
+	this->Index.Clear();
+	for (int i = 0; i < (int)this->Routes.size(); i++) {
+		long long key = ((long long)this->Routes[i].Src << 32) | (unsigned int)this->Routes[i].Dest;
+		this->Index.Insert(key, i);
+	}
+
+	return added;
+}
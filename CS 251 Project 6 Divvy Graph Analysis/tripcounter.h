@@ -0,0 +1,52 @@
+//
+// tripcounter.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <vector>
+
+#include "graph.h"
+#include "hashindex.h"
+
+using namespace std;
+
+
+//
+// TripCounter class
+//
+// Counts trips per (source, destination) vertex pair.  Each ingest
+// worker owns one; the counters are merged and then inserted into
+// the graph in one go, one edge per pair, with the count as weight.
+//
+class TripCounter
+{
+public:
+
+	// Route class
+	class Route
+	{
+	public:
+		int Src, Dest, Count;		// source, destination, # of trips
+	};
+
+private:
+	HashIndex<long long> Index;		// (src,dest) key -> position in Routes
+	vector<Route>        Routes;	// distinct routes, in first-seen order
+
+public:
+
+	// public function prototypes
+	void Add(int src, int dest, int count);
+	void Merge(TripCounter& other);
+	vector<Route>& GetRoutes();
+	int InsertInto(Graph& G);
+};
@@ -0,0 +1,252 @@
+//
+// tripfiles.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#include <algorithm>
+#include <filesystem>
+#include <string_view>
+
+#include "tripfiles.h"
+
+using namespace std;
+
+
+//
+// true if name matches pattern, where * stands for any run of
+// characters and ? for any one character
+//
+static bool Matches(string_view pattern, string_view name)
+{
+	size_t p = 0, n = 0;
+	size_t star = string_view::npos, resume = 0;	// last * seen, and where its match ends
+
+	while (n < name.size()) {
+		if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+			p++;
+			n++;
+		}
+		else if (p < pattern.size() && pattern[p] == '*') {
+			star = p++;
+			resume = n;
+		}
+		else if (star != string_view::npos) {
+			// let the last * swallow one more character
+			p = star + 1;
+			n = ++resume;
+		}
+		else {
+			return false;
+		}
+	}
+
+	while (p < pattern.size() && pattern[p] == '*')
+		p++;
+
+	return p == pattern.size();
+}
+
+
+//
+// ExpandTripFiles:
+//
+// Turns a comma-separated list of trips files into the filenames, e.g.
+//
+//   Divvy_Trips_2016_Q1.csv, Divvy_Trips_2016_Q2.csv
+//   data/Divvy_Trips_201*.csv
+//
+// An entry with * or ? in its file name (not its directory) stands for
+// the matching files, sorted by name; other entries are kept as typed,
+// whether or not they exist.
+//
+vector<string> ExpandTripFiles(string spec)
+{
+	vector<string> filenames;
+	size_t         start = 0;
+
+	while (start <= spec.size()) {
+		size_t comma = spec.find(',', start);
+		if (comma == string::npos)
+			comma = spec.size();
+
+		// the entry, without surrounding blanks
+		string entry = spec.substr(start, comma - start);
+		size_t first = entry.find_first_not_of(" \t\r");
+		size_t last = entry.find_last_not_of(" \t\r");
+
+		start = comma + 1;
+		if (first == string::npos)
+			continue;
+		entry = entry.substr(first, last - first + 1);
+
+		if (entry.find_first_of("*?") == string::npos) {
+			filenames.push_back(entry);
+			continue;
+		}
+
+		// a pattern: scan its directory
+		filesystem::path pattern(entry);
+		filesystem::path dir = pattern.parent_path();
+		string           name = pattern.filename().string();
+		vector<string>   matches;
+		error_code       ec;
+
+		for (filesystem::directory_iterator it(dir.empty() ? filesystem::path(".") : dir, ec), end;
+			!ec && it != end; it.increment(ec)) {
+			string candidate = it->path().filename().string();
+
+			if (Matches(name, candidate) && it->is_regular_file(ec))
+				matches.push_back((dir / candidate).string());
+		}
+
+		sort(matches.begin(), matches.end());
+		filenames.insert(filenames.end(), matches.begin(), matches.end());
+	}
+
+	return filenames;
+}
+
+
+//
+// maps every file, returns false if one cannot be opened (or is a
+// damaged archive)
+//
+bool TripFiles::Open(const vector<string>& filenames)
+{
+	this->Files.clear();
+	this->Archives.clear();
+
+	for (const string& filename : filenames) {
+		this->Files.push_back(make_unique<MappedFile>());
+		this->Archives.push_back(nullptr);
+
+		if (TripArchive::IsArchive(filename)) {
+			this->Archives.back() = make_unique<TripArchive>();
+			if (!this->Archives.back()->Open(filename))
+				return false;
+		}
+		else if (!this->Files.back()->Open(filename)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+//
+// cuts the lines of each file, after its column headers, into
+// chunksPerFile line-aligned chunks of about the same size, and each
+// archive into its blocks; returned in file order, leaving out empty
+// ones
+//
+vector<TripFiles::Chunk> TripFiles::Split(int chunksPerFile)
+{
+	vector<Chunk> chunks;
+
+	for (size_t f = 0; f < this->Files.size(); f++) {
+		TripArchive *archive = this->Archives[f].get();
+
+		if (archive != nullptr) {
+			for (int b = 0; b < archive->GetNumBlocks(); b++)
+				chunks.push_back(Chunk{ nullptr, nullptr, archive, b });
+			continue;
+		}
+
+		MappedFile *file = this->Files[f].get();
+		CsvScanner  input(file->Data(), file->Size());
+		string_view line;
+
+		input.NextLine(line);		// skip first line: column headers
+
+		const char *begin = file->Data() + input.Offset(file->Data());
+		const char *end = file->Data() + file->Size();
+
+		vector<const char *> bounds = CsvScanner::SplitChunks(begin, end, max(chunksPerFile, 1));
+		for (size_t c = 0; c + 1 < bounds.size(); c++) {
+			if (bounds[c] < bounds[c + 1])
+				chunks.push_back(Chunk{ bounds[c], bounds[c + 1], nullptr, -1 });
+		}
+	}
+
+	return chunks;
+}
+
+
+// # of bytes over all the files
+size_t TripFiles::TotalSize()
+{
+	size_t total = 0;
+
+	for (unique_ptr<MappedFile>& file : this->Files)
+		total += file->Size();
+	for (unique_ptr<TripArchive>& archive : this->Archives) {
+		if (archive != nullptr)
+			total += archive->Size();
+	}
+
+	return total;
+}
+
+
+//
+// Constructor:
+//
+// Every page starts out missing.
+//
+TripIDSet::TripIDSet()
+	: Pages(new atomic<atomic<uint64_t> *>[NumPages])
+{
+	for (uint32_t p = 0; p < NumPages; p++)
+		this->Pages[p].store(nullptr, memory_order_relaxed);
+}
+
+
+//
+// Destructor:
+//
+TripIDSet::~TripIDSet()
+{
+	for (uint32_t p = 0; p < NumPages; p++)
+		delete[] this->Pages[p].load(memory_order_relaxed);
+}
+
+
+//
+// Claim:
+//
+// Adds id to the set.  Returns true if it was not there yet, i.e. the
+// caller holds the first copy of the trip; of several threads claiming
+// the same id at once exactly one gets true.  A missing page is
+// allocated by whichever thread installs it first.
+//
+bool TripIDSet::Claim(int id)
+{
+	uint32_t                 u = (uint32_t)id;
+	atomic<atomic<uint64_t> *>& slot = this->Pages[u >> PageBits];
+	atomic<uint64_t>        *page = slot.load(memory_order_acquire);
+
+	if (page == nullptr) {
+		atomic<uint64_t> *fresh = new atomic<uint64_t>[PageWords];
+		for (uint32_t w = 0; w < PageWords; w++)
+			fresh[w].store(0, memory_order_relaxed);
+
+		// another thread may have beaten us to it, then use its page
+		if (slot.compare_exchange_strong(page, fresh, memory_order_acq_rel, memory_order_acquire))
+			page = fresh;
+		else
+			delete[] fresh;
+	}
+
+	uint32_t bit = u & ((1u << PageBits) - 1);
+	uint64_t mask = 1ull << (bit & 63);
+
+	return (page[bit >> 6].fetch_or(mask, memory_order_relaxed) & mask) == 0;
+}
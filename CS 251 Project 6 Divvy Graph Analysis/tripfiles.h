@@ -0,0 +1,100 @@
+//
+// tripfiles.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+#include "archive.h"
+#include "csvscanner.h"
+
+using namespace std;
+
+
+//
+// Several trips files read as one, e.g. the quarterly Divvy files of a
+// few years.  ExpandTripFiles() turns what the user typed into the
+// list of files, TripFiles maps them and cuts them into chunks for the
+// ingest workers, and TripIDSet drops the trips two files share (the
+// quarters overlap at the boundaries).  Any of the files may be a trip
+// archive (see archive.h) instead of a CSV file.
+//
+
+
+// function prototypes
+vector<string> ExpandTripFiles(string spec);
+
+
+//
+// TripFiles class
+//
+// The trips files, mapped together.  Each file's lines after its
+// column headers are cut into line-aligned chunks; an archive is cut
+// into its blocks.
+//
+class TripFiles
+{
+public:
+
+	// Chunk class: whole lines of one file, or one block of an archive
+	class Chunk
+	{
+	public:
+		const char  *Begin, *End;	// [Begin, End), null for a block
+		TripArchive *Archive;		// the archive of the block, null for lines
+		int          Block;			// block #, -1 for lines
+	};
+
+private:
+	vector<unique_ptr<MappedFile>>  Files;		// mapped files, in the given order
+	vector<unique_ptr<TripArchive>> Archives;	// per file, its archive if it is one
+
+public:
+
+	// public function prototypes
+	bool Open(const vector<string>& filenames);
+	vector<Chunk> Split(int chunksPerFile);
+	size_t TotalSize();
+};
+
+
+//
+// TripIDSet class
+//
+// The trip ids seen so far, as a bitmap over the 32-bit id space in
+// pages of 64K ids; a page is only allocated once one of its ids shows
+// up, so dense ids take 8 KB per 64K trips.  Claim() may be called from
+// any # of threads at once.  Not copyable.
+//
+class TripIDSet
+{
+private:
+	static const int      PageBits = 16;						// 2^PageBits ids per page
+	static const uint32_t NumPages = 1u << (32 - PageBits);
+	static const uint32_t PageWords = (1u << PageBits) / 64;	// 64-bit words per page
+
+	unique_ptr<atomic<atomic<uint64_t> *>[]> Pages;			// per page, its bits or null
+
+public:
+	TripIDSet();
+	~TripIDSet();
+
+	TripIDSet(const TripIDSet&) = delete;
+	TripIDSet& operator=(const TripIDSet&) = delete;
+
+	// public function prototypes
+	bool Claim(int id);
+};
@@ -0,0 +1,524 @@
+//
+// tripstore.cpp
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#include <algorithm>
+#include <thread>
+#include <atomic>
+
+#include "csvscanner.h"
+#include "stats.h"
+#include "tripstore.h"
+
+using namespace std;
+
+
+//
+// returns the code of the value, adding it if new; -1 once the table
+// holds 256 values, as codes are stored in a byte
+//
+int TripStore::Dictionary::Encode(string_view value)
+{
+	for (int code = 0; code < (int)this->Values.size(); code++) {
+		if (this->Values[code] == value)
+			return code;
+	}
+
+	if (this->Values.size() == 256)
+		return -1;
+
+	this->Values.push_back(string(value));
+	return (int)this->Values.size() - 1;
+}
+
+
+// the value of the given code
+const string& TripStore::Dictionary::Decode(int code)
+{
+	return this->Values[code];
+}
+
+
+// # of distinct values
+int TripStore::Dictionary::Size()
+{
+	return (int)this->Values.size();
+}
+
+
+//
+// resizes every column (but the route edges) to n trips
+//
+void TripStore::Columns::Resize(size_t n)
+{
+	this->TripIDs.resize(n);
+	this->From.resize(n);
+	this->To.resize(n);
+	this->Durations.resize(n);
+	this->BikeIDs.resize(n);
+	this->BirthYears.resize(n);
+	this->StartYears.resize(n);
+	this->StartTimes.resize(n);
+	this->StartBuckets.resize(n);
+	this->UserTypes.resize(n);
+	this->Genders.resize(n);
+}
+
+
+//
+// Constructor:
+//
+TripStore::TripStore()
+{
+	this->Loaded = false;
+	this->NumMoves = 0;
+}
+
+
+//
+// remembers the trips files EnsureLoaded() reads
+//
+void TripStore::SetSource(const vector<string>& filenames)
+{
+	this->Filenames = filenames;
+}
+
+
+//
+// loads the trips files given to SetSource() the first time it is
+// called, by whichever thread gets there first; returns false if the
+// store could not be loaded
+//
+bool TripStore::EnsureLoaded(Graph& G, StationIndex& index)
+{
+	call_once(this->LoadOnce, [&]() {
+		if (!this->Filenames.empty())
+			this->Load(this->Filenames, G, index, (int)thread::hardware_concurrency());
+	});
+
+	return this->Loaded;
+}
+
+
+//
+// parses the trips in [begin, end), which must start at the beginning
+// of a line, appending them to trips; the dictionaries are the
+// chunk's own.  Trips from / to unknown stations, on routes the graph
+// does not have, or with a trip_id already in seen are skipped.
+//
+void TripStore::ParseChunk(const char *begin, const char *end, Graph& G, StationIndex& index,
+	TripIDSet& seen, Columns& trips, Dictionary& userTypes, Dictionary& genders)
+{
+	CsvScanner  input(begin, end - begin);
+	string_view line;
+
+	while (input.NextLine(line))
+	{
+		// format:
+		//   trip_id,starttime,stoptime,bikeid,tripduration,from_station_id,from_station_name,to_station_id,to_station_name,usertype,gender,birthyear
+		//   10426287,6/30/2016 22:48,6/30/2016 23:13,4199,1521,145,Mies van der Rohe Way & Chestnut St,35,Streeter Dr & Grand Ave,Customer,,
+		//
+		string_view fields[12];
+		int tripID, bikeID, fromID, toID, duration, birthYear = 0, year, startTime;
+		double seconds;
+
+		// gender and birthyear may be left out
+		int numFields = CsvScanner::Split(line, fields, 12);
+		if (numFields < 10
+			|| !CsvScanner::ParseInt(fields[0], tripID)
+			|| !CsvScanner::ParseInt(fields[3], bikeID)
+			|| !CsvScanner::ParseInt(fields[5], fromID)
+			|| !CsvScanner::ParseInt(fields[7], toID))
+			continue;
+
+		// whole seconds, some files write them with decimals
+		if (!CsvScanner::ParseInt(fields[4], duration)) {
+			if (!CsvScanner::ParseDouble(fields[4], seconds))
+				continue;
+			duration = (int)(seconds + 0.5);
+		}
+
+		if (numFields >= 12 && !fields[11].empty() && !CsvScanner::ParseInt(fields[11], birthYear))
+			birthYear = 0;
+
+		int bucket = ParseTimeBucket(fields[1], year, startTime);
+		if (bucket == -1)
+			continue;
+
+		// the route, as an edge of the frozen graph
+		int fromV = index.VertexOf(index.Find(fromID));
+		int toV = index.VertexOf(index.Find(toID));
+		int e = G.FindEdge(fromV, toV);
+
+		int userType = userTypes.Encode(fields[9]);
+		int gender = genders.Encode((numFields >= 11) ? fields[10] : string_view());
+
+		if (e == -1 || userType == -1 || gender == -1)
+			continue;
+
+		// a trip another file already had, as in ProcessTrips; claimed
+		// only once the line is known good, so a malformed copy does not
+		// shadow a good one
+		if (!seen.Claim(tripID))
+			continue;
+
+		trips.TripIDs.push_back(tripID);
+		trips.From.push_back(fromV);
+		trips.To.push_back(toV);
+		trips.Durations.push_back(duration);
+		trips.BikeIDs.push_back(bikeID);
+		trips.BirthYears.push_back((int16_t)birthYear);
+		trips.StartYears.push_back((int16_t)year);
+		trips.StartTimes.push_back(startTime);
+		trips.StartBuckets.push_back((uint8_t)bucket);
+		trips.UserTypes.push_back((uint8_t)userType);
+		trips.Genders.push_back((uint8_t)gender);
+		trips.Edges.push_back(e);
+	}
+}
+
+
+//
+// same for block # block of the archive, which keeps the fields
+// ParseChunk reads: a trip is skipped exactly when ParseChunk would
+// skip its line
+//
+void TripStore::ParseBlock(TripArchive& archive, int block, Graph& G, StationIndex& index,
+	TripIDSet& seen, Columns& trips, Dictionary& userTypes, Dictionary& genders)
+{
+	TripArchive::Rows rows;
+	if (!archive.Decode(block, rows, true))
+		return;
+
+	vector<int> vertexOf = archive.StationVertices(index);
+	const uint8_t wanted = TripArchive::HasTripID | TripArchive::HasDetail;
+
+	for (size_t i = 0; i < rows.Flags.size(); i++) {
+		uint8_t f = rows.Flags[i];
+
+		if ((f & wanted) != wanted)
+			continue;
+
+		// a duration and a start time the store can take
+		if (!(f & TripArchive::HasDuration) || !(f & TripArchive::HasTime))
+			continue;
+
+		int fromV = vertexOf[rows.From[i]];
+		int toV = vertexOf[rows.To[i]];
+		int e = G.FindEdge(fromV, toV);
+
+		int userType = userTypes.Encode(archive.GetUserTypes()[rows.UserTypes[i]]);
+		int gender = genders.Encode(archive.GetGenders()[rows.Genders[i]]);
+
+		if (e == -1 || userType == -1 || gender == -1 || !seen.Claim(rows.TripIDs[i]))
+			continue;
+
+		trips.TripIDs.push_back(rows.TripIDs[i]);
+		trips.From.push_back(fromV);
+		trips.To.push_back(toV);
+		trips.Durations.push_back(rows.Durations[i]);
+		trips.BikeIDs.push_back(rows.BikeIDs[i]);
+		trips.BirthYears.push_back(rows.BirthYears[i]);
+		trips.StartYears.push_back(rows.StartYears[i]);
+		trips.StartTimes.push_back(rows.StartTimes[i]);
+		trips.StartBuckets.push_back((uint8_t)rows.Buckets[i]);
+		trips.UserTypes.push_back((uint8_t)userType);
+		trips.Genders.push_back((uint8_t)gender);
+		trips.Edges.push_back(e);
+	}
+}
+
+
+//
+// reads every trip of the files into the store, parsing line-aligned
+// chunks (or archive blocks) in numThreads workers and then grouping the trips by route;
+// a trip_id seen before is dropped, as in ProcessTrips.  The graph must
+// be frozen and built from the same files.  Returns false if it is
+// not, or a file cannot be opened.
+//
+bool TripStore::Load(const vector<string>& filenames, Graph& G, StationIndex& index, int numThreads)
+{
+	STAT_TIMER(timer, Stat::TripStoreLoad);
+
+	if (!G.IsFrozen())
+		return false;
+
+	TripFiles files;
+	if (!files.Open(filenames))
+		return false;
+
+	numThreads = max(numThreads, 1);
+	vector<TripFiles::Chunk> chunks = files.Split(numThreads);
+	int                      numChunks = (int)chunks.size();
+	atomic<int>              next(0);
+	TripIDSet                seen;
+
+	// parse the chunks in the workers, each chunk into its own columns
+	// so the trips stay in file order
+	vector<Columns>    parts(numChunks);
+	vector<Dictionary> userTypes(numChunks);
+	vector<Dictionary> genders(numChunks);
+	vector<thread>     workers;
+
+	for (int t = 0; t < numThreads; t++) {
+		workers.push_back(thread([&]() {
+			for (int c = next++; c < numChunks; c = next++) {
+				if (chunks[c].Archive != nullptr)
+					ParseBlock(*chunks[c].Archive, chunks[c].Block, G, index, seen, parts[c], userTypes[c],
+						genders[c]);
+				else
+					ParseChunk(chunks[c].Begin, chunks[c].End, G, index, seen, parts[c], userTypes[c],
+						genders[c]);
+			}
+		}));
+	}
+	for (thread& w : workers)
+		w.join();
+
+	// chunk codes -> store codes, -1 for a value past the store's 256
+	vector<vector<int>> userTypeCodes(numChunks), genderCodes(numChunks);
+
+	for (int t = 0; t < numChunks; t++) {
+		for (int c = 0; c < userTypes[t].Size(); c++)
+			userTypeCodes[t].push_back(this->UserTypeNames.Encode(userTypes[t].Decode(c)));
+		for (int c = 0; c < genders[t].Size(); c++)
+			genderCodes[t].push_back(this->GenderNames.Encode(genders[t].Decode(c)));
+	}
+
+	// a trip is skipped if a value got no code, as in ParseChunk
+	auto kept = [&](int t, size_t i) {
+		return userTypeCodes[t][parts[t].UserTypes[i]] != -1 && genderCodes[t][parts[t].Genders[i]] != -1;
+	};
+
+	// # of trips per route, then where each route starts
+	int numEdges = G.GetNumEdges();
+	this->EdgeStart.assign(numEdges + 1, 0);
+
+	for (int t = 0; t < numChunks; t++) {
+		for (size_t i = 0; i < parts[t].Edges.size(); i++) {
+			if (kept(t, i))
+				this->EdgeStart[parts[t].Edges[i] + 1]++;
+		}
+	}
+	for (int e = 0; e < numEdges; e++)
+		this->EdgeStart[e + 1] += this->EdgeStart[e];
+
+	// scatter the chunks' trips in file order
+	vector<int> fill(this->EdgeStart.begin(), this->EdgeStart.end() - 1);
+	this->Trips.Resize(this->EdgeStart[numEdges]);
+
+	for (int t = 0; t < numChunks; t++) {
+		Columns& part = parts[t];
+
+		for (size_t i = 0; i < part.Edges.size(); i++) {
+			if (!kept(t, i))
+				continue;
+
+			int at = fill[part.Edges[i]]++;
+
+			this->Trips.TripIDs[at] = part.TripIDs[i];
+			this->Trips.From[at] = part.From[i];
+			this->Trips.To[at] = part.To[i];
+			this->Trips.Durations[at] = part.Durations[i];
+			this->Trips.BikeIDs[at] = part.BikeIDs[i];
+			this->Trips.BirthYears[at] = part.BirthYears[i];
+			this->Trips.StartYears[at] = part.StartYears[i];
+			this->Trips.StartTimes[at] = part.StartTimes[i];
+			this->Trips.StartBuckets[at] = part.StartBuckets[i];
+			this->Trips.UserTypes[at] = (uint8_t)userTypeCodes[t][part.UserTypes[i]];
+			this->Trips.Genders[at] = (uint8_t)genderCodes[t][part.Genders[i]];
+		}
+
+		part = Columns();		// release the chunk's copy early
+	}
+
+	// bike trajectories, and the moves between them as a second edge
+	// type over the graph's vertices
+	{
+		STAT_TIMER(movesTimer, Stat::DetectMoves);
+
+		TripCounter moves;
+		this->Bikes.Build(this->Trips.BikeIDs, this->Trips.StartTimes, this->Trips.TripIDs, numThreads);
+		this->NumMoves = this->Bikes.DetectMoves(this->Trips.From, this->Trips.To, moves, numThreads);
+
+		vector<int> srcs, dests, counts;
+		for (TripCounter::Route& r : moves.GetRoutes()) {
+			srcs.push_back(r.Src);
+			dests.push_back(r.Dest);
+			counts.push_back(r.Count);
+		}
+		this->Moves.Build(srcs, dests, counts, G.GetNumVertices());
+
+		STAT_ITEMS(movesTimer, this->GetNumTrips());
+	}
+
+	this->Flows.Build(this->Trips.From, this->Trips.To, this->Trips.StartTimes, this->Trips.Durations,
+		this->Trips.StartBuckets, G.GetNumVertices());
+
+	this->Loaded = true;
+
+	STAT_ITEMS(timer, this->GetNumTrips());
+	return true;
+}
+
+
+// true once the trips are loaded
+bool TripStore::IsLoaded()
+{
+	return this->Loaded;
+}
+
+
+// # of trips in the store
+int TripStore::GetNumTrips()
+{
+	return (int)this->Trips.Durations.size();
+}
+
+
+//
+// the trips on edge e are [EdgeBegin(e), EdgeEnd(e)); the trips leaving
+// vertex v are [EdgeBegin(Offsets[v]), EdgeBegin(Offsets[v+1]))
+//
+int TripStore::EdgeBegin(int e)
+{
+	return (e >= 0 && e < (int)this->EdgeStart.size()) ? this->EdgeStart[e] : 0;
+}
+
+int TripStore::EdgeEnd(int e)
+{
+	return (e >= 0 && e + 1 < (int)this->EdgeStart.size()) ? this->EdgeStart[e + 1] : 0;
+}
+
+
+//
+// Summarize:
+//
+// Aggregates the trips [begin, end): durations, usertype and gender
+// counts and age bands (age = start year - birth year).  Unless
+// allBuckets, only the trips starting in a bucket of the mask count.
+// Each aggregate is a pass over one column.
+//
+TripSummary TripStore::Summarize(int begin, int end, const BucketMask& mask, bool allBuckets)
+{
+	TripSummary summary;
+	const Columns& trips = this->Trips;
+
+	summary.UserTypes.assign(this->UserTypeNames.Size(), 0);
+	summary.Genders.assign(this->GenderNames.Size(), 0);
+
+	// the trips in the chosen buckets, if any
+	vector<int> rows;
+	if (!allBuckets) {
+		for (int i = begin; i < end; i++) {
+			int bucket = trips.StartBuckets[i];
+			if (bucket < NumTimeBuckets && mask[bucket])
+				rows.push_back(i);
+		}
+	}
+
+	auto forRows = [&](auto f) {
+		if (allBuckets) {
+			for (int i = begin; i < end; i++)
+				f(i);
+		}
+		else {
+			for (int i : rows)
+				f(i);
+		}
+	};
+
+	summary.Trips = allBuckets ? max(end - begin, 0) : (int)rows.size();
+	if (summary.Trips == 0)
+		return summary;
+
+	// durations
+	long long total = 0;
+	int       shortest = trips.Durations[allBuckets ? begin : rows[0]];
+	int       longest = shortest;
+
+	forRows([&](int i) {
+		int d = trips.Durations[i];
+		total += d;
+		shortest = min(shortest, d);
+		longest = max(longest, d);
+	});
+
+	summary.TotalDuration = total;
+	summary.MinDuration = shortest;
+	summary.MaxDuration = longest;
+
+	// usertypes and genders
+	forRows([&](int i) { summary.UserTypes[trips.UserTypes[i]]++; });
+	forRows([&](int i) { summary.Genders[trips.Genders[i]]++; });
+
+	// age bands, trips without a sensible birth year left out
+	forRows([&](int i) {
+		int age = trips.StartYears[i] - trips.BirthYears[i];
+
+		if (trips.BirthYears[i] > 0 && age >= 0 && age < 120) {
+			summary.AgeBands[min(max(age / 10 - 1, 0), NumAgeBands - 1)]++;
+			summary.WithAge++;
+			summary.TotalAge += age;
+		}
+	});
+
+	return summary;
+}
+
+
+// getter for the usertype dictionary
+TripStore::Dictionary& TripStore::GetUserTypeNames()
+{
+	return this->UserTypeNames;
+}
+
+
+// getter for the gender dictionary
+TripStore::Dictionary& TripStore::GetGenderNames()
+{
+	return this->GenderNames;
+}
+
+
+// getter for the columns, grouped by route
+const TripStore::Columns& TripStore::GetColumns()
+{
+	return this->Trips;
+}
+
+
+// getter for the bike trajectories
+BikeIndex& TripStore::GetBikes()
+{
+	return this->Bikes;
+}
+
+
+// the rebalancing moves between stations
+MoveEdges& TripStore::GetMoves()
+{
+	return this->Moves;
+}
+
+
+// # of rebalancing moves found in the trajectories
+long long TripStore::GetNumMoves()
+{
+	return this->NumMoves;
+}
+
+
+// the trips per station and hour of the day
+DockFlows& TripStore::GetFlows()
+{
+	return this->Flows;
+}
@@ -0,0 +1,162 @@
+//
+// tripstore.h
+//
+//-----------------------------------------------------------------------------
+// Author: Michal Bochnak, mbochn2
+// Project: Divvy Graph Analysis
+// Class: CS 251
+// Professor: Joseph Hummel
+// Date: April 18, 2017
+//-----------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+#include "bikeindex.h"
+#include "dockflows.h"
+#include "graph.h"
+#include "station.h"
+#include "timebuckets.h"
+#include "tripfiles.h"
+
+using namespace std;
+
+
+//
+// ages are summarized in bands of 10 years: under 20, 20-29, .. 60-69,
+// 70 and over
+//
+const int NumAgeBands = 7;
+
+
+//
+// TripSummary class
+//
+// Aggregates over a range of trips, see TripStore::Summarize().
+//
+class TripSummary
+{
+public:
+	int         Trips = 0;					// # of trips
+	long long   TotalDuration = 0;			// sum of the durations, in seconds
+	int         MinDuration = 0;			// shortest trip, in seconds
+	int         MaxDuration = 0;			// longest trip, in seconds
+	vector<int> UserTypes;					// # of trips per usertype code
+	vector<int> Genders;					// # of trips per gender code
+	int         AgeBands[NumAgeBands] = { 0 };	// # of trips per age band
+	int         WithAge = 0;				// # of trips with a known age
+	long long   TotalAge = 0;				// sum of the known ages
+};
+
+
+//
+// TripStore class
+//
+// Every trip with the fields the graph drops, stored column-wise: one
+// array per field, with usertype and gender dictionary-encoded and the
+// stations as vertex #'s.  Trips are grouped by route in the frozen
+// graph's edge order (file order within a route), so the trips on edge
+// e are [EdgeStart[e], EdgeStart[e+1]) and the trips leaving a vertex
+// are one range as well; aggregates are tight loops over a column.
+//
+// Loading also indexes the trips by bike and keeps the rebalancing
+// moves it infers from them as edges between the graph's vertices (see
+// BikeIndex, MoveEdges); the graph itself is only read.  A trip the
+// store skips (e.g. to an unknown station) breaks its bike's
+// trajectory and may show up as a move.  It also counts the trips
+// leaving and arriving at each station by hour (see DockFlows).
+//
+// Optional: nothing is read until Load(), or until EnsureLoaded() is
+// first called by a query that needs the trips.
+//
+class TripStore
+{
+public:
+
+	//
+	// Dictionary class
+	//
+	// Small table of the distinct values of a field, the code of a
+	// value is its position.
+	//
+	class Dictionary
+	{
+	private:
+		vector<string> Values;			// distinct values, by code
+
+	public:
+		int Encode(string_view value);
+		const string& Decode(int code);
+		int Size();
+	};
+
+	//
+	// Columns class
+	//
+	// The fields of a set of trips, in the order they were added.
+	//
+	class Columns
+	{
+	public:
+		vector<int32_t> TripIDs;		// Divvy trip id
+		vector<int32_t> From;			// source vertex
+		vector<int32_t> To;				// destination vertex
+		vector<int32_t> Durations;		// tripduration, in seconds
+		vector<int32_t> BikeIDs;		// Divvy bike id
+		vector<int16_t> BirthYears;		// 0 if not given
+		vector<int16_t> StartYears;		// year of the starttime
+		vector<int32_t> StartTimes;		// starttime, in seconds since 1/1/2000
+		vector<uint8_t> StartBuckets;	// time bucket of the starttime
+		vector<uint8_t> UserTypes;		// usertype code
+		vector<uint8_t> Genders;		// gender code, "" if not given
+		vector<int>     Edges;			// route edge #, only while loading
+
+		void Resize(size_t n);
+	};
+
+private:
+	Columns     Trips;					// every trip, grouped by route
+	vector<int> EdgeStart;				// per edge, NumEdges+1 entries
+	Dictionary  UserTypeNames;			// usertype code -> text
+	Dictionary  GenderNames;			// gender code -> text
+	BikeIndex   Bikes;					// trips by bike and start time
+	MoveEdges   Moves;					// the moves, by (from, to) station
+	long long   NumMoves;				// # of rebalancing moves found
+	DockFlows   Flows;					// trips per station and hour of the day
+
+	vector<string> Filenames;			// trips files for EnsureLoaded()
+	once_flag   LoadOnce;				// EnsureLoaded() loads once
+	bool        Loaded;					// true once loaded
+
+	// private function prototypes
+	static void ParseChunk(const char *begin, const char *end, Graph& G, StationIndex& index,
+		TripIDSet& seen, Columns& trips, Dictionary& userTypes, Dictionary& genders);
+	static void ParseBlock(TripArchive& archive, int block, Graph& G, StationIndex& index,
+		TripIDSet& seen, Columns& trips, Dictionary& userTypes, Dictionary& genders);
+
+public:
+	TripStore();
+
+	// public function prototypes
+	void SetSource(const vector<string>& filenames);
+	bool EnsureLoaded(Graph& G, StationIndex& index);
+	bool Load(const vector<string>& filenames, Graph& G, StationIndex& index, int numThreads);
+	bool IsLoaded();
+	int GetNumTrips();
+	int EdgeBegin(int e);
+	int EdgeEnd(int e);
+	TripSummary Summarize(int begin, int end, const BucketMask& mask, bool allBuckets);
+	Dictionary& GetUserTypeNames();
+	Dictionary& GetGenderNames();
+	const Columns& GetColumns();
+	BikeIndex& GetBikes();
+	MoveEdges& GetMoves();
+	long long GetNumMoves();
+	DockFlows& GetFlows();
+};